@@ -0,0 +1,37 @@
+#include "cpptools/adaptive_mutex.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+#include "cpptools/spinlock_mutex.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::bm_lock_contended;
+using cpptools::bench::max_threads;
+
+void bm_adaptive_mutex(benchmark::State& s) {
+    using cpptools::adaptive_mutex;
+
+    adaptive_mutex m;
+    for (auto _ : s) {
+        std::scoped_lock l(m);
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_adaptive_mutex);
+
+// Contended, up to the core count and then oversubscribed at 2x and 4x,
+// where a preempted holder makes pure spinners burn their whole quantum
+void oversubscribed(benchmark::internal::Benchmark* b) {
+    b->ThreadRange(2, max_threads())
+        ->Threads(2 * max_threads())
+        ->Threads(4 * max_threads())
+        ->UseRealTime();
+}
+
+BENCHMARK(bm_lock_contended<std::mutex>)->Apply(oversubscribed);
+BENCHMARK(bm_lock_contended<cpptools::spinlock_mutex>)->Apply(oversubscribed);
+BENCHMARK(bm_lock_contended<cpptools::adaptive_mutex>)->Apply(oversubscribed);
+
+BENCHMARK_MAIN();
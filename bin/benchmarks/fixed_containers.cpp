@@ -0,0 +1,183 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cpptools/fixed_flat_map.hpp"
+#include "cpptools/fixed_string.hpp"
+#include "cpptools/fixed_vector.hpp"
+
+using cpptools::fixed_flat_map;
+using cpptools::fixed_string;
+using cpptools::fixed_vector;
+
+static constexpr size_t QUERIES = 4096;
+
+// Random indices in [0, n), the same for every container
+std::vector<uint32_t> queries(size_t n) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> q(QUERIES);
+    for (uint32_t& i : q) {
+        i = rng() % n;
+    }
+    return q;
+}
+
+std::string symbol(uint32_t i) { return "SYM" + std::to_string(i * 7919); }
+
+// Random reads by index
+
+template <size_t N>
+void bm_fixed_vector_index(benchmark::State& s) {
+    auto v = std::make_unique<fixed_vector<uint64_t, N>>();
+    for (size_t i = 0; i < N; ++i) {
+        v->push_back(i);
+    }
+    const auto q = queries(N);
+
+    size_t next{0};
+    for (auto _ : s) {
+        benchmark::DoNotOptimize((*v)[q[next++ % QUERIES]]);
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_fixed_vector_index<64>);
+BENCHMARK(bm_fixed_vector_index<16384>);
+
+template <size_t N>
+void bm_std_vector_index(benchmark::State& s) {
+    std::vector<uint64_t> v;
+    for (size_t i = 0; i < N; ++i) {
+        v.push_back(i);
+    }
+    const auto q = queries(N);
+
+    size_t next{0};
+    for (auto _ : s) {
+        benchmark::DoNotOptimize(v[q[next++ % QUERIES]]);
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_std_vector_index<64>);
+BENCHMARK(bm_std_vector_index<16384>);
+
+// Integer-keyed lookups of keys that are present
+
+template <size_t N>
+void bm_fixed_flat_map_find(benchmark::State& s) {
+    auto m = std::make_unique<fixed_flat_map<uint32_t, uint64_t, N>>();
+    for (uint32_t i = 0; i < N; ++i) {
+        m->insert(i * 3, i);
+    }
+    auto q = queries(N);
+    for (uint32_t& i : q) {
+        i *= 3;
+    }
+
+    size_t next{0};
+    for (auto _ : s) {
+        benchmark::DoNotOptimize(m->find(q[next++ % QUERIES]));
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_fixed_flat_map_find<64>);
+BENCHMARK(bm_fixed_flat_map_find<1024>);
+BENCHMARK(bm_fixed_flat_map_find<16384>);
+
+template <typename Map, size_t N>
+void bm_std_map_find(benchmark::State& s) {
+    Map m;
+    for (uint32_t i = 0; i < N; ++i) {
+        m.emplace(i * 3, i);
+    }
+    auto q = queries(N);
+    for (uint32_t& i : q) {
+        i *= 3;
+    }
+
+    size_t next{0};
+    for (auto _ : s) {
+        benchmark::DoNotOptimize(m.find(q[next++ % QUERIES]));
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_std_map_find<std::map<uint32_t, uint64_t>, 64>);
+BENCHMARK(bm_std_map_find<std::map<uint32_t, uint64_t>, 1024>);
+BENCHMARK(bm_std_map_find<std::map<uint32_t, uint64_t>, 16384>);
+BENCHMARK(bm_std_map_find<std::unordered_map<uint32_t, uint64_t>, 64>);
+BENCHMARK(bm_std_map_find<std::unordered_map<uint32_t, uint64_t>, 1024>);
+BENCHMARK(bm_std_map_find<std::unordered_map<uint32_t, uint64_t>, 16384>);
+
+// Symbol lookups: fixed_string keys in a fixed_flat_map, searched by
+// string_view, against std::string keys in std::map
+
+template <size_t N>
+void bm_fixed_string_map_find(benchmark::State& s) {
+    auto m = std::make_unique<fixed_flat_map<fixed_string<15>, uint64_t, N>>();
+    std::vector<std::string> symbols;
+    for (uint32_t i = 0; i < N; ++i) {
+        symbols.push_back(symbol(i));
+        m->insert(std::string_view(symbols.back()), i);
+    }
+    const auto q = queries(N);
+
+    size_t next{0};
+    for (auto _ : s) {
+        const std::string_view key = symbols[q[next++ % QUERIES]];
+        benchmark::DoNotOptimize(m->find(key));
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_fixed_string_map_find<64>);
+BENCHMARK(bm_fixed_string_map_find<1024>);
+
+template <size_t N>
+void bm_std_string_map_find(benchmark::State& s) {
+    std::map<std::string, uint64_t, std::less<>> m;
+    std::vector<std::string> symbols;
+    for (uint32_t i = 0; i < N; ++i) {
+        symbols.push_back(symbol(i));
+        m.emplace(symbols.back(), i);
+    }
+    const auto q = queries(N);
+
+    size_t next{0};
+    for (auto _ : s) {
+        const std::string_view key = symbols[q[next++ % QUERIES]];
+        benchmark::DoNotOptimize(m.find(key));
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_std_string_map_find<64>);
+BENCHMARK(bm_std_string_map_find<1024>);
+
+// Hash lookups, comparing fixed_string and std::string as keys
+
+template <typename String, size_t N>
+void bm_string_hash_find(benchmark::State& s) {
+    std::unordered_map<String, uint64_t> m;
+    std::vector<String> keys;
+    for (uint32_t i = 0; i < N; ++i) {
+        keys.emplace_back(symbol(i));
+        m.emplace(keys.back(), i);
+    }
+    const auto q = queries(N);
+
+    size_t next{0};
+    for (auto _ : s) {
+        benchmark::DoNotOptimize(m.find(keys[q[next++ % QUERIES]]));
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_string_hash_find<fixed_string<15>, 1024>);
+BENCHMARK(bm_string_hash_find<std::string, 1024>);
+
+BENCHMARK_MAIN();
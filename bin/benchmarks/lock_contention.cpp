@@ -0,0 +1,187 @@
+#include "lock_contention.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "cpptools/adaptive_mutex.hpp"
+#include "cpptools/adaptive_mutex_ipc.hpp"
+#include "cpptools/cpu_topology.hpp"
+#include "cpptools/mcs_mutex.hpp"
+#include "cpptools/shared_spinlock_mutex.hpp"
+#include "cpptools/shared_spinlock_mutex_ipc.hpp"
+#include "cpptools/spinlock_mutex.hpp"
+#include "cpptools/spinlock_mutex_ipc.hpp"
+#include "cpptools/thread.hpp"
+#include "cpptools/ticket_mutex.hpp"
+#include "cpptools/ticket_mutex_ipc.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using cpptools::bench::max_threads;
+using cpptools::bench::percentile;
+
+static constexpr auto RUN_TIME = std::chrono::milliseconds(100);
+static constexpr size_t MAX_SAMPLES = 1 << 16;
+
+// Busy-waits for ns nanoseconds, standing in for real work
+static void spin_for(int64_t ns) {
+    if (ns <= 0) {
+        return;
+    }
+    const auto end = clock_type::now() + std::chrono::nanoseconds(ns);
+    while (clock_type::now() < end);
+}
+
+// IPC locks live in shared memory and are constructed from a name
+template <typename Lock>
+static std::unique_ptr<Lock> make_lock() {
+    if constexpr (std::is_constructible_v<Lock, std::string_view>) {
+        return std::make_unique<Lock>(
+            std::string_view("/cpptools_bench_lock_contention"));
+    } else {
+        return std::make_unique<Lock>();
+    }
+}
+
+// What one worker thread saw
+struct worker_stats {
+    uint64_t acquisitions{0};
+    std::vector<int64_t> samples;  // Acquisition latencies, in ns
+};
+
+// s.range(0) threads, each pinned to its own allowed CPU while there are
+// enough, take the lock for s.range(1) ns of work and then think for
+// s.range(2) ns outside it, for RUN_TIME. Reports throughput, acquisition
+// latency percentiles across all threads, and per-thread fairness: Jain's
+// index over acquisition counts (1 when every thread got the same share,
+// 1/threads when one thread got them all) and the smallest thread's share
+// relative to an even split.
+template <typename Lock>
+void bm_contention(benchmark::State& s) {
+    const int threads = s.range(0);
+    const int64_t critical_ns = s.range(1);
+    const int64_t think_ns = s.range(2);
+
+    const std::vector<int> cpus = cpptools::cpu_topology().allowed();
+
+    auto lock = make_lock<Lock>();
+    uint64_t counter{0};
+    std::vector<worker_stats> stats(threads);
+
+    for (auto _ : s) {
+        std::atomic<int> ready{0};
+        std::atomic<bool> stop{false};
+        for (auto& st : stats) {
+            st.acquisitions = 0;
+            st.samples.clear();
+            st.samples.reserve(MAX_SAMPLES);
+        }
+
+        auto work = [&](worker_stats& st) {
+            ready.fetch_add(1);
+            while (ready.load(std::memory_order_acquire) < threads + 1) {
+                std::this_thread::yield();
+            }
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto start = clock_type::now();
+                lock->lock();
+                const auto acquired = clock_type::now();
+                benchmark::DoNotOptimize(++counter);
+                spin_for(critical_ns);
+                lock->unlock();
+
+                ++st.acquisitions;
+                if (st.samples.size() < MAX_SAMPLES) {
+                    st.samples.push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            acquired - start)
+                            .count());
+                }
+                spin_for(think_ns);
+            }
+        };
+
+        std::vector<cpptools::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            cpptools::thread_attributes attributes;
+            if (!cpus.empty()) {
+                attributes.cpus = {cpus[t % cpus.size()]};
+            }
+            workers.emplace_back(attributes, work, std::ref(stats[t]));
+        }
+        while (ready.load() < threads) {
+            std::this_thread::yield();
+        }
+
+        const auto start = clock_type::now();
+        ready.fetch_add(1, std::memory_order_release);
+        std::this_thread::sleep_for(RUN_TIME);
+        stop.store(true);
+        for (auto& w : workers) {
+            w.join();
+        }
+        const auto end = clock_type::now();
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+
+    uint64_t total{0};
+    double sum_squares{0};
+    uint64_t fewest = stats.front().acquisitions;
+    std::vector<int64_t> samples;
+    for (const auto& st : stats) {
+        total += st.acquisitions;
+        sum_squares += static_cast<double>(st.acquisitions) * st.acquisitions;
+        fewest = std::min(fewest, st.acquisitions);
+        samples.insert(samples.end(), st.samples.begin(), st.samples.end());
+    }
+
+    s.SetItemsProcessed(total);
+    s.counters["p50_ns"] = percentile(samples, 50);
+    s.counters["p99_ns"] = percentile(samples, 99);
+    s.counters["p999_ns"] = percentile(samples, 99.9);
+    s.counters["jain_fairness"] =
+        sum_squares > 0 ? static_cast<double>(total) * total /
+                              (threads * sum_squares)
+                        : 0.0;
+    s.counters["min_share_pct"] =
+        total > 0 ? 100.0 * fewest * threads / total : 0.0;
+}
+
+// Threads from 1 up to the core count in powers of 2, critical sections of
+// 0, 100 and 1000 ns, and no think time or 1000 ns of it
+static void sweep(benchmark::internal::Benchmark* b) {
+    std::vector<int64_t> threads;
+    for (int t = 1; t < max_threads(); t *= 2) {
+        threads.push_back(t);
+    }
+    threads.push_back(max_threads());
+
+    b->ArgNames({"threads", "critical_ns", "think_ns"})
+        ->ArgsProduct({threads, {0, 100, 1000}, {0, 1000}})
+        ->UseManualTime()
+        ->Iterations(1);
+}
+
+BENCHMARK(bm_contention<std::mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::spinlock_mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::spinlock_mutex_ipc>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::adaptive_mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::adaptive_mutex_ipc>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::ticket_mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::ticket_mutex_ipc>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::mcs_mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::shared_spinlock_mutex>)->Apply(sweep);
+BENCHMARK(bm_contention<cpptools::shared_spinlock_mutex_ipc>)->Apply(sweep);
+
+BENCHMARK_MAIN();
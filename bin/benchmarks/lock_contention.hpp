@@ -0,0 +1,80 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace cpptools::bench {
+
+// Upper bound for ThreadRange() sweeps: at least 2, at most the core count
+inline int max_threads() {
+    return std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Returns the p-th percentile (p in [0, 100]) of samples, sorting them
+inline double percentile(std::vector<int64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const size_t idx = static_cast<size_t>(p / 100.0 * (samples.size() - 1));
+    return static_cast<double>(samples[idx]);
+}
+
+// Times lock() on a mutex shared by all benchmark threads. The critical
+// section bumps a shared counter so the protected cache line moves too.
+// Fairness is reported as the share of acquisitions in which a thread
+// re-took the mutex straight after releasing it: FIFO locks keep this near
+// zero under contention, unfair locks let the releasing core win repeatedly.
+template <typename Mutex>
+void bm_lock_contended(benchmark::State& s) {
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t MAX_SAMPLES = 1 << 20;
+
+    static Mutex m;
+    static uint64_t counter{0};
+    static int last_owner{-1};
+
+    const int self = s.thread_index();
+    int64_t reacquired{0};
+
+    std::vector<int64_t> samples;
+    samples.reserve(MAX_SAMPLES);
+
+    for (auto _ : s) {
+        const auto start = clock::now();
+        m.lock();
+        const auto acquired = clock::now();
+
+        benchmark::DoNotOptimize(++counter);
+        reacquired += (last_owner == self);
+        last_owner = self;
+        m.unlock();
+
+        if (samples.size() < MAX_SAMPLES) {
+            samples.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(acquired -
+                                                                     start)
+                    .count());
+        }
+    }
+
+    s.SetItemsProcessed(s.iterations());
+    s.counters["p50_ns"] = benchmark::Counter(percentile(samples, 50),
+                                              benchmark::Counter::kAvgThreads);
+    s.counters["p99_ns"] = benchmark::Counter(percentile(samples, 99),
+                                              benchmark::Counter::kAvgThreads);
+    s.counters["p999_ns"] = benchmark::Counter(
+        percentile(samples, 99.9), benchmark::Counter::kAvgThreads);
+    s.counters["reacquire_pct"] = benchmark::Counter(
+        100.0 * reacquired / std::max<int64_t>(s.iterations(), 1),
+        benchmark::Counter::kAvgThreads);
+}
+
+}  // namespace cpptools::bench
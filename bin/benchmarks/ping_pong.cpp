@@ -0,0 +1,500 @@
+#include <benchmark/benchmark.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpptools/backoff.hpp"
+#include "cpptools/cpu_topology.hpp"
+#include "cpptools/macros.hpp"
+#include "cpptools/semaphore_lock.hpp"
+#include "cpptools/shared_memory.hpp"
+#include "cpptools/thread.hpp"
+#include "lock_contention.hpp"
+
+// Two processes pinned to chosen cores bounce a cache line through
+// shared_memory: the pinger writes a sequence number and a timestamp to its
+// line, the ponger waits for it, records the one-way latency and echoes the
+// number on its own line, and the pinger times the round trip.
+//
+// By default, runs every wait technique on a pair of cores of each kind the
+// machine has (same core, SMT sibling, same socket, cross socket). Extra
+// flags:
+//   --histograms  print every run's latency histograms afterwards
+//   --matrix      print a core-to-core latency matrix instead, over every
+//                 pair of allowed CPUs, with spin_pause
+
+using clock_type = std::chrono::steady_clock;
+using cpptools::bench::percentile;
+
+static constexpr uint32_t WARMUP = 1000;
+static constexpr uint32_t ROUND_TRIPS = 20000;
+static constexpr uint32_t MATRIX_ROUND_TRIPS = 2000;
+static constexpr const char* SHM_NAME = "/cpptools_bench_ping_pong";
+static constexpr const char* SEM_NAMES[] = {"/cpptools_bench_ping_pong_0",
+                                            "/cpptools_bench_ping_pong_1",
+                                            "/cpptools_bench_ping_pong_2"};
+
+// How a side waits for the other and wakes it
+enum class technique {
+    spin,        // Polls the other side's line
+    spin_pause,  // Polls with a pause instruction in between
+    futex,       // Sleeps on the other side's line, woken by FUTEX_WAKE
+    semaphore,   // Hands a pair of semaphore_locks back and forth
+};
+
+static constexpr std::string_view technique_name(technique t) {
+    switch (t) {
+        case technique::spin:
+            return "spin";
+        case technique::spin_pause:
+            return "spin_pause";
+        case technique::futex:
+            return "futex";
+        case technique::semaphore:
+            return "semaphore";
+    }
+    return "";
+}
+
+// Each side's line is written only by that side
+struct channel {
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> ping;
+    std::atomic<int64_t> sent_ns;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> pong;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> ready;
+    int64_t one_way_ns[ROUND_TRIPS];  // Recorded by the ponger
+};
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               clock_type::now().time_since_epoch())
+        .count();
+}
+
+// Shared (not FUTEX_PRIVATE_FLAG) futex ops, as the sides are processes
+static void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT,
+            expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1,
+            nullptr, nullptr, 0);
+}
+
+// One side of the ping-pong: role 0 pings, role 1 pongs. Round trip i
+// sends i each way.
+//
+// With semaphores, every message hands one of three semaphore_locks over,
+// in turn: message n (2i - 1 for a ping, 2i for a pong) moves semaphore
+// n % 3 from sender to receiver. The pinger starts out holding 0 and 1, the
+// ponger 2. A sender never waits for the semaphore it just released, so the
+// receiver is the only one after it; with two, the sender could take it
+// straight back.
+template <technique T>
+class endpoint {
+public:
+    endpoint(channel* ch, uint32_t role)
+        : m_out(role == 0 ? ch->ping : ch->pong),
+          m_in(role == 0 ? ch->pong : ch->ping),
+          m_role(role) {
+        if constexpr (T == technique::semaphore) {
+            cpptools::semaphore_options options;
+            options.mode = cpptools::semaphore_mode::blocking;
+            for (int s = 0; s < 3; ++s) {
+                m_semaphores[s] = std::make_unique<cpptools::semaphore_lock>(
+                    SEM_NAMES[s], options);
+            }
+            if (role == 0) {
+                m_semaphores[0]->lock();
+                m_semaphores[1]->lock();
+            } else {
+                m_semaphores[2]->lock();
+            }
+        }
+    }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(endpoint);
+
+    void send(uint32_t i) {
+        if constexpr (T == technique::semaphore) {
+            m_semaphores[(2 * i - 1 + m_role) % 3]->unlock();
+        } else {
+            m_out.store(i, std::memory_order_release);
+            if constexpr (T == technique::futex) {
+                futex_wake(m_out);
+            }
+        }
+    }
+
+    void receive(uint32_t i) {
+        if constexpr (T == technique::semaphore) {
+            m_semaphores[(2 * i - m_role) % 3]->lock();
+        } else {
+            uint32_t seen;
+            while ((seen = m_in.load(std::memory_order_acquire)) != i) {
+                if constexpr (T == technique::spin_pause) {
+                    cpptools::cpu_relax();
+                } else if constexpr (T == technique::futex) {
+                    futex_wait(m_in, seen);
+                }
+            }
+        }
+    }
+
+private:
+    std::atomic<uint32_t>& m_out;
+    std::atomic<uint32_t>& m_in;
+    uint32_t m_role;
+    std::unique_ptr<cpptools::semaphore_lock> m_semaphores[3];
+};
+
+struct ping_pong_result {
+    std::vector<int64_t> round_trip_ns;
+    std::vector<int64_t> one_way_ns;
+    double seconds{0};
+    std::string error;  // Why the run failed, empty if it didn't
+};
+
+// Pins the calling thread to core for its lifetime, then restores the
+// previous affinity
+class pin_scope {
+public:
+    explicit pin_scope(int core) {
+        sched_getaffinity(0, sizeof(m_previous), &m_previous);
+        cpptools::thread self;
+        m_pinned = self.set_core(core);
+    }
+    ~pin_scope() { sched_setaffinity(0, sizeof(m_previous), &m_previous); }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(pin_scope);
+
+    bool pinned() const { return m_pinned; }
+
+private:
+    cpu_set_t m_previous;
+    bool m_pinned;
+};
+
+static void remove_semaphores() {
+    for (const char* name : SEM_NAMES) {
+        cpptools::semaphore_lock::remove(name);
+    }
+}
+
+// Runs round_trips (after a warmup) with this process pinned to
+// pinger_cpu and a forked peer to ponger_cpu. Fails if either can't be
+// pinned.
+template <technique T>
+static ping_pong_result ping_pong(int pinger_cpu, int ponger_cpu,
+                                  uint32_t round_trips) {
+    cpptools::shared_memory shm(SHM_NAME, sizeof(channel));
+    channel* ch = shm.as_struct<channel>();
+    ch->ping.store(0);
+    ch->pong.store(0);
+    ch->ready.store(0);
+
+    ping_pong_result result;
+    const pin_scope pin(pinger_cpu);
+    if (!pin.pinned()) {
+        result.error = std::format("Failed to pin the pinger to CPU {}",
+                                   pinger_cpu);
+        return result;
+    }
+
+    if constexpr (T == technique::semaphore) {
+        remove_semaphores();
+    }
+    endpoint<T> pinger(ch, 0);
+
+    // The child inherits the mapping, opens its own semaphores and skips
+    // destructors on exit
+    const pid_t pid = fork();
+    if (pid == 0) {
+        cpptools::thread self;
+        if (!self.set_core(ponger_cpu)) {
+            _exit(1);
+        }
+        endpoint<T> ponger(ch, 1);
+        ch->ready.store(1, std::memory_order_release);
+        for (uint32_t i = 1; i <= WARMUP + round_trips; ++i) {
+            ponger.receive(i);
+            if (i > WARMUP) {
+                ch->one_way_ns[i - WARMUP - 1] =
+                    now_ns() - ch->sent_ns.load(std::memory_order_relaxed);
+            }
+            ponger.send(i);
+        }
+        _exit(0);
+    }
+
+    // The peer may share this core, or have exited without getting ready
+    int status{0};
+    while (ch->ready.load(std::memory_order_acquire) == 0) {
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            if constexpr (T == technique::semaphore) {
+                remove_semaphores();
+            }
+            result.error =
+                WIFEXITED(status) && WEXITSTATUS(status) == 1
+                    ? std::format("Failed to pin the ponger to CPU {}",
+                                  ponger_cpu)
+                    : std::string("Ponger died before starting");
+            return result;
+        }
+        sched_yield();
+    }
+
+    result.round_trip_ns.reserve(round_trips);
+    const auto start = clock_type::now();
+    for (uint32_t i = 1; i <= WARMUP + round_trips; ++i) {
+        const int64_t sent = now_ns();
+        ch->sent_ns.store(sent, std::memory_order_relaxed);
+        pinger.send(i);
+        pinger.receive(i);
+        if (i > WARMUP) {
+            result.round_trip_ns.push_back(now_ns() - sent);
+        }
+    }
+    const auto end = clock_type::now();
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        result.error = "Ponger failed";
+    }
+
+    result.one_way_ns.assign(ch->one_way_ns, ch->one_way_ns + round_trips);
+    result.seconds = std::chrono::duration<double>(end - start).count();
+
+    if constexpr (T == technique::semaphore) {
+        remove_semaphores();
+    }
+    return result;
+}
+
+// Histograms of the runs so far, printed after the benchmarks
+struct histogram_entry {
+    std::string name;
+    ping_pong_result result;
+};
+static std::vector<histogram_entry> histograms;
+static bool keep_histograms{false};
+
+template <technique T>
+void bm_ping_pong(benchmark::State& s, const std::string& name, int pinger_cpu,
+                  int ponger_cpu) {
+    ping_pong_result result;
+    for (auto _ : s) {
+        result = ping_pong<T>(pinger_cpu, ponger_cpu, ROUND_TRIPS);
+        if (!result.error.empty()) {
+            s.SkipWithError(result.error.c_str());
+            break;
+        }
+        s.SetIterationTime(result.seconds);
+    }
+    if (!result.error.empty()) {
+        return;
+    }
+
+    if (keep_histograms) {
+        histograms.push_back({name, result});
+    }
+
+    auto& rtt = result.round_trip_ns;
+    auto& one_way = result.one_way_ns;
+    s.SetItemsProcessed(s.iterations() * ROUND_TRIPS);
+    s.counters["rtt_p50_ns"] = percentile(rtt, 50);
+    s.counters["rtt_p99_ns"] = percentile(rtt, 99);
+    s.counters["rtt_p999_ns"] = percentile(rtt, 99.9);
+    s.counters["rtt_max_ns"] = percentile(rtt, 100);
+    s.counters["one_way_p50_ns"] = percentile(one_way, 50);
+    s.counters["one_way_p99_ns"] = percentile(one_way, 99);
+    s.counters["one_way_p999_ns"] = percentile(one_way, 99.9);
+}
+
+struct core_pair {
+    std::string_view kind;
+    int a;
+    int b;
+};
+
+// One pair of allowed CPUs of each kind the machine has
+static std::vector<core_pair> pick_pairs(const cpptools::cpu_topology& topo) {
+    std::vector<core_pair> pairs;
+    const auto& allowed = topo.allowed();
+    if (allowed.empty()) {
+        return pairs;
+    }
+    pairs.push_back({"same_core", allowed[0], allowed[0]});
+
+    for (int cpu : allowed) {
+        bool found = false;
+        for (int sibling : topo.cpu(cpu)->smt_siblings) {
+            if (sibling != cpu && topo.is_allowed(sibling)) {
+                pairs.push_back({"smt_sibling", cpu, sibling});
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            break;
+        }
+    }
+
+    std::vector<int> cores;
+    for (int cpu : topo.physical_cores()) {
+        if (topo.is_allowed(cpu)) {
+            cores.push_back(cpu);
+        }
+    }
+    bool same_socket = false;
+    bool cross_socket = false;
+    for (size_t i = 0; i < cores.size(); ++i) {
+        for (size_t j = i + 1; j < cores.size(); ++j) {
+            const bool same =
+                topo.cpu(cores[i])->socket == topo.cpu(cores[j])->socket;
+            if (same && !same_socket) {
+                pairs.push_back({"same_socket", cores[i], cores[j]});
+                same_socket = true;
+            } else if (!same && !cross_socket) {
+                pairs.push_back({"cross_socket", cores[i], cores[j]});
+                cross_socket = true;
+            }
+        }
+    }
+    return pairs;
+}
+
+template <technique T>
+static void register_technique(const std::vector<core_pair>& pairs) {
+    for (const core_pair& pair : pairs) {
+        // Spinning on the core the other side needs only gets anywhere
+        // when the scheduler preempts the spinner
+        if ((T == technique::spin || T == technique::spin_pause) &&
+            pair.a == pair.b) {
+            continue;
+        }
+        const std::string name =
+            std::format("bm_ping_pong<{}>/{}/cpus:{},{}", technique_name(T),
+                        pair.kind, pair.a, pair.b);
+        benchmark::RegisterBenchmark(name.c_str(), bm_ping_pong<T>, name,
+                                     pair.a, pair.b)
+            ->UseManualTime()
+            ->Iterations(1);
+    }
+}
+
+// Power-of-2 buckets, from the lowest to the highest one used
+static void print_histogram(std::string_view title,
+                            const std::vector<int64_t>& samples) {
+    std::vector<uint64_t> buckets(65, 0);
+    for (int64_t ns : samples) {
+        ++buckets[std::bit_width(static_cast<uint64_t>(std::max<int64_t>(
+            ns, 0)))];
+    }
+    size_t first = 0;
+    while (first < buckets.size() && buckets[first] == 0) {
+        ++first;
+    }
+    size_t last = buckets.size();
+    while (last > first && buckets[last - 1] == 0) {
+        --last;
+    }
+
+    std::printf("%.*s\n", static_cast<int>(title.size()), title.data());
+    uint64_t cumulative{0};
+    for (size_t b = first; b < last; ++b) {
+        cumulative += buckets[b];
+        std::printf("  < %12llu ns %10llu %8.3f%%\n",
+                    static_cast<unsigned long long>(uint64_t{1} << b),
+                    static_cast<unsigned long long>(buckets[b]),
+                    100.0 * cumulative / samples.size());
+    }
+}
+
+// Median one-way latency, half the round trip, between every pair of
+// allowed CPUs
+static void print_matrix(const cpptools::cpu_topology& topo) {
+    const auto& cpus = topo.allowed();
+    std::printf("one-way latency, ns (median round trip / 2)\n%6s", "");
+    for (int b : cpus) {
+        std::printf(" %6d", b);
+    }
+    std::printf("\n");
+
+    for (int a : cpus) {
+        std::printf("%6d", a);
+        for (int b : cpus) {
+            if (a == b) {
+                std::printf(" %6s", "-");
+                continue;
+            }
+            auto result =
+                ping_pong<technique::spin_pause>(a, b, MATRIX_ROUND_TRIPS);
+            if (!result.error.empty()) {
+                std::fprintf(stderr, "%s\n", result.error.c_str());
+                std::printf(" %6s", "?");
+                continue;
+            }
+            std::printf(" %6.0f", percentile(result.round_trip_ns, 50) / 2);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv) {
+    // Take out this harness's own flags before benchmark sees them
+    bool matrix = false;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--matrix") == 0) {
+            matrix = true;
+        } else if (std::strcmp(argv[i], "--histograms") == 0) {
+            keep_histograms = true;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    const cpptools::cpu_topology topo;
+    if (matrix) {
+        print_matrix(topo);
+        return 0;
+    }
+
+    const auto pairs = pick_pairs(topo);
+    register_technique<technique::spin>(pairs);
+    register_technique<technique::spin_pause>(pairs);
+    register_technique<technique::futex>(pairs);
+    register_technique<technique::semaphore>(pairs);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    for (const auto& entry : histograms) {
+        print_histogram(entry.name + " round trip",
+                        entry.result.round_trip_ns);
+        print_histogram(entry.name + " one way", entry.result.one_way_ns);
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "cpptools/semaphore_lock.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+#include "lock_contention.hpp"
+
+using clock_type = std::chrono::steady_clock;
+using cpptools::semaphore_lock;
+using cpptools::semaphore_mode;
+using cpptools::bench::percentile;
+
+static constexpr uint64_t HANDOFFS = 10000;
+static constexpr const char* SEM_NAME = "/cpptools_bench_sem";
+
+// Handoff bookkeeping shared by the two processes
+struct control {
+    std::atomic<uint64_t> waiting;   // Handoff the acquirer is waiting for
+    std::atomic<uint64_t> acquired;  // Last completed handoff
+    std::atomic<int64_t> released_ns;
+};
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               clock_type::now().time_since_epoch())
+        .count();
+}
+
+static double cpu_seconds(int who) {
+    rusage usage{};
+    getrusage(who, &usage);
+    const auto seconds = [](const timeval& tv) {
+        return static_cast<double>(tv.tv_sec) + tv.tv_usec / 1e6;
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+// Passes the semaphore back and forth: handoff k goes from process
+// (k - 1) % 2 to process k % 2, and process 0 starts out holding it. The
+// releaser waits until the other process is about to lock(), keeps the
+// semaphore for hold_us more, then releases it and waits for the handoff to
+// complete, so it can't take the semaphore straight back.
+static void hand_off(semaphore_lock& sem, control* ctl, uint64_t me,
+                     std::chrono::microseconds hold,
+                     std::vector<int64_t>* samples) {
+    for (uint64_t k = 1; k <= HANDOFFS; ++k) {
+        if (k % 2 == me) {
+            ctl->waiting.store(k, std::memory_order_release);
+            // try_once leaves retrying to the caller, as a yielding loop
+            while (!sem.lock()) {
+                std::this_thread::yield();
+            }
+            const int64_t acquired = now_ns();
+            if (samples != nullptr) {
+                samples->push_back(
+                    acquired -
+                    ctl->released_ns.load(std::memory_order_acquire));
+            }
+            ctl->acquired.store(k, std::memory_order_release);
+        } else {
+            while (ctl->waiting.load(std::memory_order_acquire) != k) {
+                std::this_thread::yield();
+            }
+            if (hold.count() > 0) {
+                std::this_thread::sleep_for(hold);
+            }
+            ctl->released_ns.store(now_ns(), std::memory_order_release);
+            sem.unlock();
+            while (ctl->acquired.load(std::memory_order_acquire) != k) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+// Handoff latency between two processes, from unlock() in one to lock()
+// returning in the other, with the semaphore held s.range(0) microseconds
+// once the other process starts waiting. cpu_pct is the CPU time both
+// processes used over the wall time: what waiting costs.
+template <semaphore_mode Mode>
+void bm_handoff(benchmark::State& s) {
+    const std::chrono::microseconds hold(s.range(0));
+
+    cpptools::semaphore_options options;
+    options.mode = Mode;
+    options.timeout = std::chrono::seconds(10);
+
+    cpptools::shared_memory ctl_mem("/cpptools_bench_sem_ctl",
+                                    sizeof(control));
+    control* ctl = ctl_mem.as_struct<control>();
+
+    std::vector<int64_t> samples;
+    samples.reserve(HANDOFFS);
+    for (auto _ : s) {
+        ctl->waiting.store(0);
+        ctl->acquired.store(0);
+        semaphore_lock::remove(SEM_NAME);
+        semaphore_lock sem(SEM_NAME, options);
+        sem.lock();
+
+        // The child opens its own instance, and skips destructors on exit
+        const pid_t pid = fork();
+        if (pid == 0) {
+            semaphore_lock child(SEM_NAME, options);
+            hand_off(child, ctl, 1, hold, nullptr);
+            _exit(0);
+        }
+
+        const double cpu_before =
+            cpu_seconds(RUSAGE_SELF) + cpu_seconds(RUSAGE_CHILDREN);
+        const auto start = clock_type::now();
+        hand_off(sem, ctl, 0, hold, &samples);
+        waitpid(pid, nullptr, 0);
+        const auto end = clock_type::now();
+        const double cpu = cpu_seconds(RUSAGE_SELF) +
+                           cpu_seconds(RUSAGE_CHILDREN) - cpu_before;
+
+        const double elapsed =
+            std::chrono::duration<double>(end - start).count();
+        s.SetIterationTime(elapsed);
+        s.counters["cpu_pct"] = 100.0 * cpu / elapsed;
+    }
+
+    semaphore_lock::remove(SEM_NAME);
+    s.SetItemsProcessed(s.iterations() * HANDOFFS);
+    s.counters["p50_ns"] = percentile(samples, 50);
+    s.counters["p99_ns"] = percentile(samples, 99);
+    s.counters["p999_ns"] = percentile(samples, 99.9);
+}
+BENCHMARK(bm_handoff<semaphore_mode::try_once>)
+    ->ArgName("hold_us")
+    ->Arg(0)
+    ->Arg(50)
+    ->UseManualTime()
+    ->Iterations(1);
+BENCHMARK(bm_handoff<semaphore_mode::blocking>)
+    ->ArgName("hold_us")
+    ->Arg(0)
+    ->Arg(50)
+    ->UseManualTime()
+    ->Iterations(1);
+BENCHMARK(bm_handoff<semaphore_mode::timed>)
+    ->ArgName("hold_us")
+    ->Arg(0)
+    ->Arg(50)
+    ->UseManualTime()
+    ->Iterations(1);
+BENCHMARK(bm_handoff<semaphore_mode::spin_then_block>)
+    ->ArgName("hold_us")
+    ->Arg(0)
+    ->Arg(50)
+    ->UseManualTime()
+    ->Iterations(1);
+
+BENCHMARK_MAIN();
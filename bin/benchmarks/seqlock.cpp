@@ -0,0 +1,81 @@
+#include "cpptools/seqlock.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "cpptools/shared_memory.hpp"
+#include "cpptools/spinlock_mutex_ipc.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::max_threads;
+
+// A latest-price style snapshot, one and a half cache lines
+struct snapshot {
+    uint64_t seq;
+    std::array<double, 11> levels;
+};
+
+// Thread 0 publishes continuously, the others read; reads/s is reported
+// as the reader count grows, together with how many reads had to retry
+
+void bm_seqlock(benchmark::State& s) {
+    static cpptools::shared_memory shmem("/cpptools_bench_seqlock",
+                                         sizeof(cpptools::seqlock<snapshot>));
+    auto* lock = shmem.as_struct<cpptools::seqlock<snapshot>>();
+
+    snapshot value{};
+    uint64_t reads{0};
+    uint64_t retries{0};
+    for (auto _ : s) {
+        if (s.thread_index() == 0) {
+            ++value.seq;
+            lock->write(value);
+        } else {
+            while (!lock->try_read(value, 1)) {
+                ++retries;
+            }
+            ++reads;
+        }
+        benchmark::DoNotOptimize(value);
+    }
+
+    s.counters["reads"] =
+        benchmark::Counter(reads, benchmark::Counter::kIsRate);
+    s.counters["retries"] = benchmark::Counter(retries);
+}
+BENCHMARK(bm_seqlock)->DenseThreadRange(2, max_threads() + 1)->UseRealTime();
+
+// The same, with the snapshot behind a spinlock_mutex_ipc
+
+void bm_spinlock_mutex_ipc(benchmark::State& s) {
+    static cpptools::shared_memory shmem("/cpptools_bench_seqlock_data",
+                                         sizeof(snapshot));
+    static cpptools::spinlock_mutex_ipc lock("/cpptools_bench_seqlock_lock");
+    auto* shared = shmem.as_struct<snapshot>();
+
+    snapshot value{};
+    uint64_t reads{0};
+    for (auto _ : s) {
+        std::scoped_lock l(lock);
+        if (s.thread_index() == 0) {
+            ++value.seq;
+            *shared = value;
+        } else {
+            value = *shared;
+            ++reads;
+        }
+        benchmark::DoNotOptimize(value);
+    }
+
+    s.counters["reads"] =
+        benchmark::Counter(reads, benchmark::Counter::kIsRate);
+}
+BENCHMARK(bm_spinlock_mutex_ipc)
+    ->DenseThreadRange(2, max_threads() + 1)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
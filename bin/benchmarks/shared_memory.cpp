@@ -0,0 +1,288 @@
+#include "cpptools/shared_memory.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpptools/macros.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::max_threads;
+using cpptools::page_size;
+using cpptools::shared_memory;
+using cpptools::shared_memory_options;
+
+// Links every cache line of the segment into one random cycle, so that each
+// load depends on the previous one and hits a random page
+void build_random_cycle(std::span<uint64_t> words) {
+    constexpr size_t stride = CPPTOOLS_CACHELINE_SIZE / sizeof(uint64_t);
+    const size_t lines = words.size() / stride;
+
+    std::vector<uint64_t> order(lines);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin() + 1, order.end(), std::mt19937_64(42));
+
+    for (size_t i = 0; i < lines; ++i) {
+        words[order[i] * stride] = order[(i + 1) % lines] * stride;
+    }
+}
+
+// Dependent random loads across a segment of s.range(0) MiB
+template <page_size Pages>
+void bm_random_access(benchmark::State& s) {
+    shared_memory_options options;
+    options.pages = Pages;
+
+    const size_t size = static_cast<size_t>(s.range(0)) << 20;
+    shared_memory shmem("/cpptools_bench_shmem", size, options);
+    if (Pages != page_size::normal && !shmem.huge_pages()) {
+        s.SkipWithError(shmem.fallback_reason().c_str());
+        return;
+    }
+
+    std::span<uint64_t> words = shmem.as_span<uint64_t>();
+    build_random_cycle(words);
+
+    uint64_t idx{0};
+    for (auto _ : s) {
+        idx = words[idx];
+        benchmark::DoNotOptimize(idx);
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_random_access<page_size::normal>)
+    ->RangeMultiplier(4)
+    ->Range(16, 1024);
+BENCHMARK(bm_random_access<page_size::huge_2mb>)
+    ->RangeMultiplier(4)
+    ->Range(16, 1024);
+BENCHMARK(bm_random_access<page_size::huge_1gb>)
+    ->RangeMultiplier(4)
+    ->Range(16, 1024);
+
+// Page-in modes for first-touch benchmarks
+enum class page_in { none, populate, prefault, lock, willneed };
+
+// Latency of the first write to each page of a freshly attached 64 MiB
+// segment, after paging it in with the given mode. Reports the time the
+// attach itself took as attach_ms.
+template <page_in Mode>
+void bm_first_touch(benchmark::State& s) {
+    using clock = std::chrono::steady_clock;
+    constexpr size_t size = size_t{64} << 20;
+
+    shared_memory_options options;
+    options.populate = (Mode == page_in::populate);
+    options.prefault = (Mode == page_in::prefault);
+    options.lock_pages = (Mode == page_in::lock);
+    options.advice = (Mode == page_in::willneed) ? MADV_WILLNEED : MADV_NORMAL;
+
+    double attach_ns{0};
+    size_t pages{0};
+    for (auto _ : s) {
+        shared_memory shmem("/cpptools_bench_shmem", size, options);
+        const auto& t = shmem.attach_timings();
+        attach_ns += (t.map + t.advise + t.prefault + t.lock).count();
+
+        std::span<std::byte> bytes = shmem.as_span<std::byte>();
+        const size_t page = shmem.page_bytes();
+
+        const auto start = clock::now();
+        for (size_t i = 0; i < bytes.size(); i += page) {
+            bytes[i] = std::byte{1};
+        }
+        const auto end = clock::now();
+
+        pages += bytes.size() / page;
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+
+    s.counters["ns_per_page"] = benchmark::Counter(
+        static_cast<double>(pages), benchmark::Counter::kIsRate |
+                                        benchmark::Counter::kInvert);
+    s.counters["attach_ms"] = benchmark::Counter(
+        attach_ns / 1e6, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(bm_first_touch<page_in::none>)->UseManualTime();
+BENCHMARK(bm_first_touch<page_in::populate>)->UseManualTime();
+BENCHMARK(bm_first_touch<page_in::prefault>)->UseManualTime();
+BENCHMARK(bm_first_touch<page_in::lock>)->UseManualTime();
+BENCHMARK(bm_first_touch<page_in::willneed>)->UseManualTime();
+
+// Time for grow() to extend a 1 MiB growable segment by s.range(0) MiB,
+// optionally prefaulting the new pages as part of it
+template <bool Prefault>
+void bm_grow(benchmark::State& s) {
+    using clock = std::chrono::steady_clock;
+    constexpr size_t size = size_t{1} << 20;
+
+    shared_memory_options options;
+    options.max_size = size_t{1} << 30;
+    options.prefault = Prefault;
+
+    const size_t grown = size + (static_cast<size_t>(s.range(0)) << 20);
+    for (auto _ : s) {
+        shared_memory shmem("/cpptools_bench_shmem", size, options);
+
+        const auto start = clock::now();
+        const bool ok = shmem.grow(grown);
+        const auto end = clock::now();
+
+        if (!ok) {
+            s.SkipWithError("segment is locked");
+            return;
+        }
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+}
+BENCHMARK(bm_grow<false>)->RangeMultiplier(8)->Range(1, 512)->UseManualTime();
+BENCHMARK(bm_grow<true>)->RangeMultiplier(8)->Range(1, 512)->UseManualTime();
+
+// Random reads from the first 16 MiB of a growable segment by a reader
+// that calls refresh() before each one. With Growing, another thread keeps
+// growing the segment by 1 MiB meanwhile, so the reader also remaps.
+template <bool Growing>
+void bm_read_while_growing(benchmark::State& s) {
+    constexpr size_t size = size_t{16} << 20;
+
+    shared_memory_options options;
+    options.max_size = size_t{1} << 30;
+
+    shared_memory reader("/cpptools_bench_shmem", size, options);
+    std::span<uint64_t> words = reader.as_span<uint64_t>();
+    build_random_cycle(words);
+
+    std::atomic<bool> stop{false};
+    std::thread grower;
+    if (Growing) {
+        grower = std::thread([&] {
+            shared_memory owner("/cpptools_bench_shmem", size, options);
+            size_t grown = size;
+            while (!stop.load(std::memory_order_relaxed) &&
+                   grown < options.max_size) {
+                grown += size_t{1} << 20;
+                owner.grow(grown);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    uint64_t idx{0};
+    uint64_t remaps{0};
+    for (auto _ : s) {
+        remaps += reader.refresh();
+        idx = words[idx];
+        benchmark::DoNotOptimize(idx);
+    }
+
+    stop = true;
+    if (grower.joinable()) {
+        grower.join();
+    }
+
+    s.SetItemsProcessed(s.iterations());
+    s.counters["remaps"] = benchmark::Counter(static_cast<double>(remaps));
+}
+BENCHMARK(bm_read_while_growing<false>);
+BENCHMARK(bm_read_while_growing<true>);
+
+// Latency of creating and destroying a 1 MiB segment, named or memfd-backed
+template <bool Anonymous>
+void bm_create(benchmark::State& s) {
+    constexpr size_t size = size_t{1} << 20;
+
+    for (auto _ : s) {
+        if constexpr (Anonymous) {
+            shared_memory shmem(cpptools::memfd, "cpptools_bench_shmem", size);
+            benchmark::DoNotOptimize(shmem.data());
+        } else {
+            shared_memory shmem("/cpptools_bench_shmem", size);
+            benchmark::DoNotOptimize(shmem.data());
+        }
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_create<false>);
+BENCHMARK(bm_create<true>);
+
+// Latency of attaching to and detaching from an existing 1 MiB segment: by
+// name, or through its memfd descriptor
+template <bool Anonymous>
+void bm_attach(benchmark::State& s) {
+    constexpr size_t size = size_t{1} << 20;
+
+    if constexpr (Anonymous) {
+        shared_memory owner(cpptools::memfd, "cpptools_bench_shmem", size);
+        for (auto _ : s) {
+            shared_memory shmem(cpptools::memfd, owner.fd(), size);
+            benchmark::DoNotOptimize(shmem.data());
+        }
+    } else {
+        shared_memory owner("/cpptools_bench_shmem", size);
+        for (auto _ : s) {
+            shared_memory shmem("/cpptools_bench_shmem", size);
+            benchmark::DoNotOptimize(shmem.data());
+        }
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_attach<false>);
+BENCHMARK(bm_attach<true>);
+
+// Time to bring up s.range(0) distinct 64 KiB named segments, as a process
+// does at startup, reported per segment
+void bm_startup(benchmark::State& s) {
+    using clock = std::chrono::steady_clock;
+    constexpr size_t size = size_t{64} << 10;
+    const auto count = static_cast<size_t>(s.range(0));
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back(std::format("/cpptools_bench_shmem_{}", i));
+    }
+
+    for (auto _ : s) {
+        std::vector<std::unique_ptr<shared_memory>> segments;
+        segments.reserve(count);
+
+        const auto start = clock::now();
+        for (const auto& name : names) {
+            segments.push_back(std::make_unique<shared_memory>(name, size));
+        }
+        const auto end = clock::now();
+
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    s.SetItemsProcessed(s.iterations() * count);
+}
+BENCHMARK(bm_startup)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Threads racing to create-or-attach the same segment and then detaching,
+// so that it keeps being created, shared and destroyed
+void bm_create_or_attach_contended(benchmark::State& s) {
+    constexpr size_t size = size_t{64} << 10;
+
+    for (auto _ : s) {
+        shared_memory shmem("/cpptools_bench_shmem", size);
+        benchmark::DoNotOptimize(shmem.data());
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_create_or_attach_contended)
+    ->ThreadRange(1, max_threads())
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+#include "cpptools/shared_spinlock_mutex.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+#include "cpptools/spinlock_mutex.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::max_threads;
+
+// Read-mostly workload: every s.range(0)-th acquisition on thread 0 is a
+// write, all others are reads. Exclusive-only mutexes take lock() for both.
+template <typename Mutex>
+void bm_read_mostly(benchmark::State& s) {
+    static Mutex m;
+    static uint64_t value{0};
+
+    const int64_t write_every = s.range(0);
+    int64_t n{0};
+
+    for (auto _ : s) {
+        if (s.thread_index() == 0 && write_every > 0 &&
+            ++n % write_every == 0) {
+            std::scoped_lock l(m);
+            ++value;
+        } else if constexpr (requires { m.lock_shared(); }) {
+            std::shared_lock l(m);
+            benchmark::DoNotOptimize(value);
+        } else {
+            std::scoped_lock l(m);
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    s.SetItemsProcessed(s.iterations());
+}
+
+// Arg: write interval on thread 0 (0 = reads only)
+BENCHMARK(bm_read_mostly<std::shared_mutex>)
+    ->Arg(0)
+    ->Arg(1000)
+    ->ThreadRange(1, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_read_mostly<cpptools::spinlock_mutex>)
+    ->Arg(0)
+    ->Arg(1000)
+    ->ThreadRange(1, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_read_mostly<cpptools::shared_spinlock_mutex>)
+    ->Arg(0)
+    ->Arg(1000)
+    ->ThreadRange(1, max_threads())
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,119 @@
+#include "cpptools/shm_broadcast_ring.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::percentile;
+
+using ring_t = cpptools::shm_broadcast_ring<1 << 20>;
+
+// Stop flag and reader totals shared with the child processes
+struct control {
+    std::atomic<int> stop;
+    std::atomic<int> ready;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint64_t> received;
+    std::atomic<uint64_t> overruns;
+};
+
+// Publisher latency of a s.range(1)-byte message while s.range(0) reader
+// processes poll the ring. Readers never write shared memory, so the
+// publisher's cost should stay flat as they are added; readers that can't
+// keep up show as overruns instead.
+void bm_publish(benchmark::State& s) {
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t MAX_SAMPLES = 1 << 20;
+
+    const int readers = s.range(0);
+    const size_t size = s.range(1);
+
+    ring_t ring("/cpptools_bench_broadcast_ring");
+    cpptools::shared_memory ctl_mem("/cpptools_bench_broadcast_ring_ctl",
+                                    sizeof(control));
+    control* ctl = ctl_mem.as_struct<control>();
+    ctl->stop.store(0);
+    ctl->ready.store(0);
+    ctl->received.store(0);
+    ctl->overruns.store(0);
+
+    // Children inherit the mappings and skip destructors on exit
+    std::vector<pid_t> pids;
+    for (int r = 0; r < readers; ++r) {
+        if (const pid_t pid = fork(); pid == 0) {
+            ring.seek_latest();
+            ctl->ready.fetch_add(1);
+            uint64_t received{0};
+            uint64_t sum{0};
+            while (ctl->stop.load(std::memory_order_relaxed) == 0) {
+                const auto status =
+                    ring.read([&](std::span<const std::byte> msg) {
+                        sum += static_cast<uint64_t>(msg.front());
+                    });
+                if (status == cpptools::broadcast_status::ok) {
+                    ++received;
+                } else if (status == cpptools::broadcast_status::empty) {
+                    std::this_thread::yield();
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+            ctl->received.fetch_add(received);
+            ctl->overruns.fetch_add(ring.overruns());
+            _exit(0);
+        } else {
+            pids.push_back(pid);
+        }
+    }
+    while (ctl->ready.load() < readers) {
+        std::this_thread::yield();
+    }
+
+    std::array<std::byte, 1024> msg{};
+    std::vector<int64_t> samples;
+    samples.reserve(MAX_SAMPLES);
+    for (auto _ : s) {
+        msg[0] = static_cast<std::byte>(samples.size());
+        const auto start = clock::now();
+        ring.publish(std::span(msg).first(size));
+        const auto end = clock::now();
+
+        if (samples.size() < MAX_SAMPLES) {
+            samples.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+                                                                     start)
+                    .count());
+        }
+    }
+
+    ctl->stop.store(1);
+    for (pid_t pid : pids) {
+        waitpid(pid, nullptr, 0);
+    }
+
+    const auto published = static_cast<double>(s.iterations());
+    s.SetItemsProcessed(s.iterations());
+    s.SetBytesProcessed(s.iterations() * size);
+    s.counters["p50_ns"] = percentile(samples, 50);
+    s.counters["p99_ns"] = percentile(samples, 99);
+    s.counters["p999_ns"] = percentile(samples, 99.9);
+    if (readers > 0) {
+        s.counters["received_pct"] =
+            100.0 * ctl->received.load() / (published * readers);
+        s.counters["overruns"] = ctl->overruns.load();
+    }
+}
+BENCHMARK(bm_publish)
+    ->ArgNames({"readers", "bytes"})
+    ->ArgsProduct({{0, 1, 2, 4, 8, 16}, {64, 1024}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,115 @@
+#include "cpptools/shm_hash_map.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+#include "cpptools/spinlock_mutex_ipc.hpp"
+
+static constexpr uint64_t KEYS = 1 << 16;
+static constexpr uint64_t LOOKUPS_PER_READER = 1 << 20;
+
+using map_t = cpptools::shm_hash_map<uint64_t, uint64_t, 2 * KEYS>;
+
+// Start flag and reader count shared with the child processes
+struct control {
+    std::atomic<int> go;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<int> readers_left;
+};
+
+// Lookups/s with s.range(0) reader processes while s.range(1) writer
+// processes keep updating random keys. With Locked, every lookup and
+// update also takes one spinlock_mutex_ipc, as a lock-guarded table would.
+template <bool Locked>
+void bm_processes(benchmark::State& s) {
+    const int readers = s.range(0);
+    const int writers = s.range(1);
+
+    map_t map("/cpptools_bench_hash_map");
+    cpptools::spinlock_mutex_ipc lock("/cpptools_bench_hash_map_lock");
+    cpptools::shared_memory ctl_mem("/cpptools_bench_hash_map_ctl",
+                                    sizeof(control));
+    control* ctl = ctl_mem.as_struct<control>();
+
+    for (uint64_t k = 0; k < KEYS; ++k) {
+        map.insert_or_assign(k, k);
+    }
+
+    for (auto _ : s) {
+        ctl->go.store(0);
+        ctl->readers_left.store(readers);
+
+        // Children inherit the mappings and skip destructors on exit
+        std::vector<pid_t> pids;
+        for (int r = 0; r < readers; ++r) {
+            if (const pid_t pid = fork(); pid == 0) {
+                while (ctl->go.load(std::memory_order_acquire) == 0);
+                uint64_t k = r * 7919;
+                uint64_t sum{0};
+                for (uint64_t i = 0; i < LOOKUPS_PER_READER; ++i) {
+                    k = (k * 6364136223846793005ULL + 1) % KEYS;
+                    if constexpr (Locked) {
+                        std::scoped_lock l(lock);
+                        sum += map.find(k).value_or(0);
+                    } else {
+                        sum += map.find(k).value_or(0);
+                    }
+                }
+                benchmark::DoNotOptimize(sum);
+                ctl->readers_left.fetch_sub(1);
+                _exit(0);
+            } else {
+                pids.push_back(pid);
+            }
+        }
+        for (int w = 0; w < writers; ++w) {
+            if (const pid_t pid = fork(); pid == 0) {
+                while (ctl->go.load(std::memory_order_acquire) == 0);
+                uint64_t k = w * 104729;
+                while (ctl->readers_left.load(std::memory_order_relaxed) > 0) {
+                    k = (k * 6364136223846793005ULL + 1) % KEYS;
+                    if constexpr (Locked) {
+                        std::scoped_lock l(lock);
+                        map.insert_or_assign(k, k);
+                    } else {
+                        map.insert_or_assign(k, k);
+                    }
+                }
+                _exit(0);
+            } else {
+                pids.push_back(pid);
+            }
+        }
+
+        // Time from releasing the children until all have exited
+        const auto start = std::chrono::steady_clock::now();
+        ctl->go.store(1, std::memory_order_release);
+        for (pid_t pid : pids) {
+            waitpid(pid, nullptr, 0);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+
+    s.SetItemsProcessed(s.iterations() * readers * LOOKUPS_PER_READER);
+}
+BENCHMARK(bm_processes<false>)
+    ->ArgNames({"readers", "writers"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1, 2}})
+    ->UseManualTime()
+    ->Iterations(3);
+BENCHMARK(bm_processes<true>)
+    ->ArgNames({"readers", "writers"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1, 2}})
+    ->UseManualTime()
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
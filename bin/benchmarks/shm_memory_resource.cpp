@@ -0,0 +1,114 @@
+#include "cpptools/shm_memory_resource.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "lock_contention.hpp"
+
+using cpptools::shm_memory_resource;
+using cpptools::bench::max_threads;
+
+static constexpr size_t SEGMENT_SIZE = size_t{64} << 20;
+static constexpr size_t LIVE_BLOCKS = 64;
+
+// Our allocation size mix: mostly small messages and nodes, some buffers,
+// the odd large snapshot
+std::vector<size_t> size_mix(unsigned seed) {
+    struct bucket {
+        int percent;
+        size_t min;
+        size_t max;
+    };
+    static constexpr std::array<bucket, 5> BUCKETS{{{60, 16, 64},
+                                                    {25, 65, 256},
+                                                    {10, 257, 1024},
+                                                    {4, 1025, 4096},
+                                                    {1, 4097, 65536}}};
+
+    std::mt19937 rng(seed);
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i < 4096; ++i) {
+        int pick = static_cast<int>(rng() % 100);
+        for (const bucket& b : BUCKETS) {
+            if (pick < b.percent) {
+                sizes.push_back(b.min + rng() % (b.max - b.min + 1));
+                break;
+            }
+            pick -= b.percent;
+        }
+    }
+    return sizes;
+}
+
+struct malloc_allocator {
+    void* allocate(size_t bytes) { return std::malloc(bytes); }
+    void deallocate(void* p, size_t) { std::free(p); }
+};
+
+template <typename Resource>
+struct resource_allocator {
+    Resource* resource;
+    void* allocate(size_t bytes) { return resource->allocate(bytes); }
+    void deallocate(void* p, size_t bytes) {
+        resource->deallocate(p, bytes);
+    }
+};
+
+// Each thread keeps LIVE_BLOCKS blocks alive and replaces the oldest one
+// per iteration, so allocations and frees interleave across size classes
+template <typename Allocator>
+void run_mix(benchmark::State& s, Allocator alloc) {
+    const std::vector<size_t> sizes = size_mix(s.thread_index());
+
+    std::array<std::pair<void*, size_t>, LIVE_BLOCKS> live{};
+    size_t next{0};
+    for (auto _ : s) {
+        auto& [p, bytes] = live[next % LIVE_BLOCKS];
+        if (p != nullptr) {
+            alloc.deallocate(p, bytes);
+        }
+        bytes = sizes[next % sizes.size()];
+        p = alloc.allocate(bytes);
+        benchmark::DoNotOptimize(p);
+        ++next;
+    }
+    for (auto& [p, bytes] : live) {
+        if (p != nullptr) {
+            alloc.deallocate(p, bytes);
+        }
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+
+void bm_malloc(benchmark::State& s) { run_mix(s, malloc_allocator{}); }
+BENCHMARK(bm_malloc)->ThreadRange(1, max_threads())->UseRealTime();
+
+void bm_synchronized_pool(benchmark::State& s) {
+    static std::pmr::synchronized_pool_resource pool;
+    run_mix(s, resource_allocator<std::pmr::memory_resource>{&pool});
+}
+BENCHMARK(bm_synchronized_pool)->ThreadRange(1, max_threads())->UseRealTime();
+
+void bm_shm_memory_resource(benchmark::State& s) {
+    static shm_memory_resource res("/cpptools_bench_shm_resource",
+                                   SEGMENT_SIZE);
+    run_mix(s, resource_allocator<shm_memory_resource>{&res});
+
+    if (s.thread_index() == 0) {
+        const auto stats = res.stats();
+        s.counters["reserved_kib"] = stats.reserved / 1024.0;
+        s.counters["external_frag"] = stats.external_fragmentation();
+    }
+}
+BENCHMARK(bm_shm_memory_resource)
+    ->ThreadRange(1, max_threads())
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include "cpptools/shm_mpmc_queue.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+
+using queue_t = cpptools::shm_mpmc_queue<uint64_t, 4096>;
+
+static constexpr uint64_t ITEMS_PER_PRODUCER = 1 << 16;
+
+// Start flag and popped-item counter shared with the child processes
+struct control {
+    std::atomic<int> go;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint64_t> popped;
+};
+
+// Items/s through the queue with s.range(0) producer processes and
+// s.range(1) consumer processes, popping in batches of s.range(2)
+void bm_processes(benchmark::State& s) {
+    const int producers = s.range(0);
+    const int consumers = s.range(1);
+    const size_t batch_size = s.range(2);
+    const uint64_t total = producers * ITEMS_PER_PRODUCER;
+
+    queue_t q("/cpptools_bench_mpmc");
+    cpptools::shared_memory ctl_mem("/cpptools_bench_mpmc_ctl",
+                                    sizeof(control));
+    control* ctl = ctl_mem.as_struct<control>();
+
+    for (auto _ : s) {
+        ctl->go.store(0);
+        ctl->popped.store(0);
+
+        // Children inherit the mappings and skip destructors on exit
+        std::vector<pid_t> pids;
+        for (int p = 0; p < producers; ++p) {
+            if (const pid_t pid = fork(); pid == 0) {
+                while (ctl->go.load(std::memory_order_acquire) == 0);
+                std::vector<uint64_t> batch(batch_size, 1);
+                for (uint64_t sent = 0; sent < ITEMS_PER_PRODUCER;) {
+                    const size_t n = std::min<uint64_t>(
+                        batch_size, ITEMS_PER_PRODUCER - sent);
+                    sent += q.push_wait(std::span(batch).first(n));
+                }
+                _exit(0);
+            } else {
+                pids.push_back(pid);
+            }
+        }
+        for (int c = 0; c < consumers; ++c) {
+            if (const pid_t pid = fork(); pid == 0) {
+                while (ctl->go.load(std::memory_order_acquire) == 0);
+                std::vector<uint64_t> batch(batch_size);
+                while (ctl->popped.load(std::memory_order_relaxed) < total) {
+                    if (const size_t n = q.pop(batch); n > 0) {
+                        ctl->popped.fetch_add(n, std::memory_order_relaxed);
+                    } else {
+                        sched_yield();
+                    }
+                }
+                _exit(0);
+            } else {
+                pids.push_back(pid);
+            }
+        }
+
+        // Time from releasing the children until all have exited
+        const auto start = std::chrono::steady_clock::now();
+        ctl->go.store(1, std::memory_order_release);
+        for (pid_t pid : pids) {
+            waitpid(pid, nullptr, 0);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        s.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+
+    s.SetItemsProcessed(s.iterations() * total);
+}
+BENCHMARK(bm_processes)
+    ->ArgNames({"producers", "consumers", "batch"})
+    ->ArgsProduct({{1, 2, 4}, {1, 2, 4}, {1, 16}})
+    ->UseManualTime()
+    ->Iterations(5);
+
+BENCHMARK_MAIN();
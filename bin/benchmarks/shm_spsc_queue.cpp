@@ -0,0 +1,72 @@
+#include "cpptools/shm_spsc_queue.hpp"
+
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using queue_t = cpptools::shm_spsc_queue<uint64_t, 4096>;
+
+static constexpr uint64_t STOP = std::numeric_limits<uint64_t>::max();
+
+// Producer -> consumer process throughput, pushing batches of s.range(0)
+void bm_throughput(benchmark::State& s) {
+    queue_t q("/cpptools_bench_spsc");
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // Consumer drains until it sees the stop value. The mapping is
+        // inherited, so use it directly and skip destructors on exit.
+        std::vector<uint64_t> batch(q.capacity());
+        for (bool stop = false; !stop;) {
+            const size_t n = q.pop(batch);
+            stop = (n > 0 && batch[n - 1] == STOP);
+        }
+        _exit(0);
+    }
+
+    const size_t batch_size = s.range(0);
+    std::vector<uint64_t> batch(batch_size, 1);
+    for (auto _ : s) {
+        for (size_t sent = 0; sent < batch_size;) {
+            sent += q.push(std::span(batch).subspan(sent));
+        }
+    }
+    while (!q.try_push(STOP));
+
+    waitpid(pid, nullptr, 0);
+    s.SetItemsProcessed(s.iterations() * batch_size);
+}
+BENCHMARK(bm_throughput)->RangeMultiplier(4)->Range(1, 256)->UseRealTime();
+
+// Round trip through a pair of queues: the peer echoes every item back
+void bm_round_trip(benchmark::State& s) {
+    queue_t ping("/cpptools_bench_spsc_ping");
+    queue_t pong("/cpptools_bench_spsc_pong");
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        for (uint64_t item = 0; item != STOP;) {
+            if (ping.try_pop(item)) {
+                while (!pong.try_push(item));
+            }
+        }
+        _exit(0);
+    }
+
+    uint64_t item{0};
+    for (auto _ : s) {
+        while (!ping.try_push(item));
+        while (!pong.try_pop(item));
+    }
+    while (!ping.try_push(STOP));
+
+    waitpid(pid, nullptr, 0);
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_round_trip)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -2,8 +2,23 @@
 
 #include <benchmark/benchmark.h>
 
+#include <atomic>
 #include <mutex>
 
+#include "lock_contention.hpp"
+
+using cpptools::bench::bm_lock_contended;
+using cpptools::bench::max_threads;
+
+// The previous spinlock_mutex::lock(): spins on test_and_set() with no backoff
+class tas_spinlock {
+    std::atomic_flag flag_{ATOMIC_FLAG_INIT};
+
+public:
+    void lock() { while (flag_.test_and_set(std::memory_order_acquire)); }
+    void unlock() { flag_.clear(std::memory_order_release); }
+};
+
 void bm_std_mutex(benchmark::State& s) {
     std::mutex m;
     for (auto _ : s) {
@@ -24,4 +39,15 @@ void bm_spinlock_mutex(benchmark::State& s) {
 }
 BENCHMARK(bm_spinlock_mutex);
 
+// Contended: throughput and acquisition latency percentiles at 2-N threads
+BENCHMARK(bm_lock_contended<std::mutex>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_lock_contended<tas_spinlock>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_lock_contended<cpptools::spinlock_mutex>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+
 BENCHMARK_MAIN();
@@ -0,0 +1,74 @@
+#include "cpptools/thread.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using clock_type = std::chrono::steady_clock;
+
+// Time from just before construction to the first instruction of the
+// thread function, reported as manual time
+template <typename Spawn>
+void spawn_latency(benchmark::State& s, Spawn spawn) {
+    for (auto _ : s) {
+        std::atomic<clock_type::rep> first{0};
+        const auto start = clock_type::now();
+        auto t = spawn([&first] {
+            first.store(clock_type::now().time_since_epoch().count(),
+                        std::memory_order_relaxed);
+        });
+        t.join();
+
+        const clock_type::time_point end{clock_type::duration(first.load())};
+        s.SetIterationTime(
+            std::chrono::duration<double>(end - start).count());
+    }
+}
+
+void bm_std_thread(benchmark::State& s) {
+    spawn_latency(s, [](auto f) { return std::thread(f); });
+}
+BENCHMARK(bm_std_thread)->UseManualTime();
+
+void bm_cpptools_thread(benchmark::State& s) {
+    spawn_latency(s, [](auto f) { return cpptools::thread(f); });
+}
+BENCHMARK(bm_cpptools_thread)->UseManualTime();
+
+// Pinned and named through attributes, before the thread runs
+void bm_cpptools_thread_attributes(benchmark::State& s) {
+    cpptools::thread_attributes attributes;
+    attributes.cpus = {0};
+    attributes.name = "bench";
+    spawn_latency(
+        s, [&](auto f) { return cpptools::thread(attributes, f); });
+}
+BENCHMARK(bm_cpptools_thread_attributes)->UseManualTime();
+
+// As above, with the stack bound to node 0
+void bm_cpptools_thread_stack_node(benchmark::State& s) {
+    cpptools::thread_attributes attributes;
+    attributes.cpus = {0};
+    attributes.name = "bench";
+    attributes.stack_node = 0;
+    spawn_latency(
+        s, [&](auto f) { return cpptools::thread(attributes, f); });
+}
+BENCHMARK(bm_cpptools_thread_stack_node)->UseManualTime();
+
+// The old way: spawn, then pin and name from the new thread
+void bm_cpptools_thread_pin_after_start(benchmark::State& s) {
+    spawn_latency(s, [](auto f) {
+        return cpptools::thread([f] {
+            cpptools::thread self;
+            self.set_core(0);
+            self.set_name("bench");
+            f();
+        });
+    });
+}
+BENCHMARK(bm_cpptools_thread_pin_after_start)->UseManualTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,214 @@
+#include "cpptools/thread_pool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "lock_contention.hpp"
+
+using cpptools::thread_pool;
+using cpptools::thread_pool_options;
+using cpptools::bench::max_threads;
+
+// The usual hand-rolled pool: one mutex-protected queue and a condition
+// variable shared by all workers
+class mutex_queue_pool {
+public:
+    explicit mutex_queue_pool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+    ~mutex_queue_pool() {
+        {
+            std::scoped_lock l(m_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) {
+            w.join();
+        }
+    }
+
+    void submit(std::function<void()> f) {
+        {
+            std::scoped_lock l(m_);
+            tasks_.push(std::move(f));
+            ++pending_;
+        }
+        cv_.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock l(m_);
+        done_cv_.wait(l, [this] { return pending_ == 0; });
+    }
+
+    // Sequential chunks, one task each, like a naive parallel_for
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, F&& f) {
+        const size_t chunk =
+            std::max<size_t>(1, (end - begin) / (4 * workers_.size()));
+        for (size_t b = begin; b < end; b += chunk) {
+            const size_t e = std::min(end, b + chunk);
+            submit([&f, b, e] {
+                for (size_t i = b; i < e; ++i) {
+                    f(i);
+                }
+            });
+        }
+        wait();
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> f;
+            {
+                std::unique_lock l(m_);
+                cv_.wait(l, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                f = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            f();
+            std::scoped_lock l(m_);
+            if (--pending_ == 0) {
+                done_cv_.notify_all();
+            }
+        }
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::queue<std::function<void()>> tasks_;
+    size_t pending_{0};
+    bool stopping_{false};
+    std::vector<std::thread> workers_;
+};
+
+constexpr int TASKS_PER_BATCH = 1000;
+
+thread_pool_options pool_options(size_t threads) {
+    thread_pool_options options;
+    options.threads = threads;
+    return options;
+}
+
+// Throughput of tiny tasks submitted from outside the pool
+void bm_mutex_queue_submit(benchmark::State& s) {
+    mutex_queue_pool pool(s.range(0));
+    std::atomic<int64_t> counter{0};
+    for (auto _ : s) {
+        for (int i = 0; i < TASKS_PER_BATCH; ++i) {
+            pool.submit(
+                [&] { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.wait();
+    }
+    s.SetItemsProcessed(s.iterations() * TASKS_PER_BATCH);
+}
+BENCHMARK(bm_mutex_queue_submit)->RangeMultiplier(2)->Range(1, max_threads());
+
+void bm_thread_pool_submit(benchmark::State& s) {
+    thread_pool pool(pool_options(s.range(0)));
+    std::atomic<int64_t> counter{0};
+    for (auto _ : s) {
+        for (int i = 0; i < TASKS_PER_BATCH; ++i) {
+            pool.submit(
+                [&] { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.wait();
+    }
+    s.SetItemsProcessed(s.iterations() * TASKS_PER_BATCH);
+}
+BENCHMARK(bm_thread_pool_submit)->RangeMultiplier(2)->Range(1, max_threads());
+
+void bm_thread_pool_submit_bulk(benchmark::State& s) {
+    thread_pool pool(pool_options(s.range(0)));
+    std::atomic<int64_t> counter{0};
+    std::vector<std::function<void()>> tasks(
+        TASKS_PER_BATCH,
+        [&] { counter.fetch_add(1, std::memory_order_relaxed); });
+    for (auto _ : s) {
+        pool.submit(tasks.begin(), tasks.end());
+        pool.wait();
+    }
+    s.SetItemsProcessed(s.iterations() * TASKS_PER_BATCH);
+}
+BENCHMARK(bm_thread_pool_submit_bulk)
+    ->RangeMultiplier(2)
+    ->Range(1, max_threads());
+
+// Tasks spawning tasks: a binary tree of depth 12, built by the workers
+void spawn_tree(thread_pool& pool, int depth) {
+    if (depth == 0) {
+        return;
+    }
+    pool.submit([&pool, depth] { spawn_tree(pool, depth - 1); });
+    pool.submit([&pool, depth] { spawn_tree(pool, depth - 1); });
+}
+
+void bm_thread_pool_spawn_tree(benchmark::State& s) {
+    constexpr int depth = 12;
+    thread_pool pool(pool_options(s.range(0)));
+    for (auto _ : s) {
+        spawn_tree(pool, depth);
+        pool.wait();
+    }
+    s.SetItemsProcessed(s.iterations() * ((2 << depth) - 2));
+}
+BENCHMARK(bm_thread_pool_spawn_tree)
+    ->RangeMultiplier(2)
+    ->Range(1, max_threads());
+
+// Scaling: squares 1M elements
+constexpr size_t N = 1 << 20;
+
+const std::vector<double>& input() {
+    static const std::vector<double> data(N, 2.0);
+    return data;
+}
+
+void bm_mutex_queue_parallel_for(benchmark::State& s) {
+    mutex_queue_pool pool(s.range(0));
+    const auto& data = input();
+    std::vector<double> out(N);
+    for (auto _ : s) {
+        pool.parallel_for(0, N, [&](size_t i) { out[i] = data[i] * data[i]; });
+        benchmark::DoNotOptimize(out.data());
+    }
+    s.SetItemsProcessed(s.iterations() * N);
+}
+BENCHMARK(bm_mutex_queue_parallel_for)
+    ->RangeMultiplier(2)
+    ->Range(1, max_threads())
+    ->UseRealTime();
+
+void bm_thread_pool_parallel_for(benchmark::State& s) {
+    thread_pool pool(pool_options(s.range(0)));
+    const auto& data = input();
+    std::vector<double> out(N);
+    for (auto _ : s) {
+        pool.parallel_for(0, N, [&](size_t i) { out[i] = data[i] * data[i]; });
+        benchmark::DoNotOptimize(out.data());
+    }
+    s.SetItemsProcessed(s.iterations() * N);
+}
+BENCHMARK(bm_thread_pool_parallel_for)
+    ->RangeMultiplier(2)
+    ->Range(1, max_threads())
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
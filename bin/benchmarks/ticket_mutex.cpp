@@ -0,0 +1,35 @@
+#include "cpptools/ticket_mutex.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+#include "cpptools/spinlock_mutex.hpp"
+#include "lock_contention.hpp"
+
+using cpptools::bench::bm_lock_contended;
+using cpptools::bench::max_threads;
+
+void bm_ticket_mutex(benchmark::State& s) {
+    using cpptools::ticket_mutex;
+
+    ticket_mutex m;
+    for (auto _ : s) {
+        std::scoped_lock l(m);
+    }
+    s.SetItemsProcessed(s.iterations());
+}
+BENCHMARK(bm_ticket_mutex);
+
+// Contended: fairness and tail latency vs. std::mutex and spinlock_mutex
+BENCHMARK(bm_lock_contended<std::mutex>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_lock_contended<cpptools::spinlock_mutex>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+BENCHMARK(bm_lock_contended<cpptools::ticket_mutex>)
+    ->ThreadRange(2, max_threads())
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
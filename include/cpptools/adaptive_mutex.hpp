@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "cpptools/macros.hpp"
+
+namespace cpptools {
+
+// Mutex that spins for a bounded budget and then parks on a futex. The
+// futex is not process-private, so the mutex also works in shared memory
+// (see adaptive_mutex_ipc). Valid when zero-initialized.
+class adaptive_mutex {
+public:
+    // Polls of the lock word before parking
+    static constexpr uint32_t DEFAULT_SPIN_BUDGET = 128;
+
+    adaptive_mutex() = default;
+    // A zero budget selects DEFAULT_SPIN_BUDGET
+    explicit adaptive_mutex(uint32_t spin_budget) noexcept
+        : spin_budget_(spin_budget) {}
+    ~adaptive_mutex() = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(adaptive_mutex);
+
+    void lock() noexcept;
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+
+    uint32_t spin_budget() const noexcept {
+        return spin_budget_ == 0 ? DEFAULT_SPIN_BUDGET : spin_budget_;
+    }
+
+private:
+    // Lock word states
+    static constexpr uint32_t UNLOCKED = 0;
+    static constexpr uint32_t LOCKED = 1;
+    static constexpr uint32_t CONTENDED = 2;  // Locked, waiters may be parked
+
+    void lock_slow() noexcept;
+
+    std::atomic<uint32_t> state_{UNLOCKED};
+    uint32_t spin_budget_{0};
+};
+
+}  // namespace cpptools
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "cpptools/adaptive_mutex.hpp"
+#include "cpptools/mutex_ipc.hpp"
+
+namespace cpptools {
+
+// Spin-then-park mutex for IPC via POSIX shared memory
+using adaptive_mutex_ipc = mutex_ipc<adaptive_mutex>;
+
+}  // namespace cpptools
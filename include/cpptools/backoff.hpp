@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace cpptools {
+
+// Hint to the CPU that we are in a spin-wait loop
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    asm volatile("" ::: "memory");
+#endif
+}
+
+// Bounds for exponential backoff, in number of cpu_relax() calls per pause
+struct backoff_limits {
+    static constexpr uint32_t DEFAULT_MIN_SPINS = 4;
+    static constexpr uint32_t DEFAULT_MAX_SPINS = 1024;
+
+    uint32_t min_spins{DEFAULT_MIN_SPINS};
+    uint32_t max_spins{DEFAULT_MAX_SPINS};
+};
+
+// Bounded exponential backoff for spin-wait loops
+class backoff {
+public:
+    // Zero-initialized limits (e.g. from freshly mapped shared memory) select
+    // the defaults
+    explicit backoff(backoff_limits limits = {}) noexcept {
+        if (limits.max_spins == 0) {
+            limits = backoff_limits{};
+        }
+
+        min_spins_ = std::max<uint32_t>(limits.min_spins, 1);
+        max_spins_ = std::max(limits.max_spins, min_spins_);
+        spins_ = min_spins_;
+    }
+
+    // Spin for the current number of iterations, then double it up to the
+    // configured maximum
+    void pause() noexcept {
+        for (uint32_t i = 0; i < spins_; ++i) {
+            cpu_relax();
+        }
+        spins_ = std::min(spins_ * 2, max_spins_);
+    }
+
+    // pause(), but first yield once at the maximum, in case whoever we're
+    // waiting for has been preempted
+    void pause_or_yield() noexcept {
+        if (spins_ >= max_spins_) {
+            std::this_thread::yield();
+        }
+        pause();
+    }
+
+    void reset() noexcept { spins_ = min_spins_; }
+
+    [[nodiscard]] uint32_t spins() const noexcept { return spins_; }
+
+private:
+    uint32_t min_spins_;
+    uint32_t max_spins_;
+    uint32_t spins_;
+};
+
+}  // namespace cpptools
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "cpptools/macros.hpp"
+
+namespace cpptools {
+
+// Lock-free Chase-Lev work-stealing deque, with the memory orderings of Le
+// et al., "Correct and Efficient Work-Stealing for Weak Memory Models". The
+// owner thread pushes and takes at the bottom (LIFO), any thread steals at
+// the top (FIFO). The buffer grows when full; retired buffers are kept
+// until the deque is destroyed since thieves may still be reading them.
+template <typename T>
+class chase_lev_deque {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Deque elements must be trivially copyable");
+
+    struct buffer {
+        explicit buffer(size_t capacity)
+            : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+        size_t capacity() const noexcept { return mask + 1; }
+
+        T get(int64_t i) const noexcept {
+            return slots[static_cast<size_t>(i) & mask].load(
+                std::memory_order_relaxed);
+        }
+        void put(int64_t i, T item) noexcept {
+            slots[static_cast<size_t>(i) & mask].store(
+                item, std::memory_order_relaxed);
+        }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    // Capacity is rounded up to a power of 2
+    explicit chase_lev_deque(size_t capacity = DEFAULT_CAPACITY) {
+        size_t pow2{1};
+        while (pow2 < capacity) {
+            pow2 <<= 1;
+        }
+        m_buffers.push_back(std::make_unique<buffer>(pow2));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+    ~chase_lev_deque() = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(chase_lev_deque);
+
+    // Owner only
+    void push(T item) {
+        const int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const int64_t t = m_top.load(std::memory_order_acquire);
+        buffer *buf = m_buffer.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(buf->capacity()) - 1) {
+            buf = grow(buf, b, t);
+        }
+
+        buf->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only
+    std::optional<T> take() noexcept {
+        const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        buffer *buf = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        std::optional<T> item = buf->get(b);
+        if (t == b) {
+            // Last item: race thieves for it
+            if (!m_top.compare_exchange_strong(t, t + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                item.reset();
+            }
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Fails if empty or if another thread won the race for the
+    // top item.
+    std::optional<T> steal() noexcept {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return std::nullopt;
+        }
+
+        const buffer *buf = m_buffer.load(std::memory_order_acquire);
+        const T item = buf->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return item;
+    }
+
+    // Approximate when called concurrently with other operations
+    size_t size() const noexcept {
+        const int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+    bool empty() const noexcept { return size() == 0; }
+
+    size_t capacity() const noexcept {
+        return m_buffer.load(std::memory_order_relaxed)->capacity();
+    }
+
+private:
+    buffer *grow(buffer *old, int64_t b, int64_t t) {
+        m_buffers.push_back(std::make_unique<buffer>(2 * old->capacity()));
+        buffer *buf = m_buffers.back().get();
+        for (int64_t i = t; i < b; ++i) {
+            buf->put(i, old->get(i));
+        }
+        m_buffer.store(buf, std::memory_order_release);
+        return buf;
+    }
+
+    // Stolen from - only written by thieves, and by the owner for the last
+    // item
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<int64_t> m_top{0};
+    // Pushed to and taken from - only written by the owner
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<int64_t> m_bottom{0};
+    std::atomic<buffer *> m_buffer{nullptr};
+    // Current buffer last, owner only
+    std::vector<std::unique_ptr<buffer>> m_buffers;
+};
+
+}  // namespace cpptools
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cpptools {
+
+// One logical CPU, as described by sysfs
+struct cpu_info {
+    int id{-1};
+    int socket{-1};     // physical_package_id
+    int core{-1};       // core_id, unique within a socket
+    int node{0};        // NUMA node
+    int l2_domain{-1};  // Lowest CPU id sharing this CPU's L2, -1 if unknown
+    int l3_domain{-1};  // Lowest CPU id sharing this CPU's L3, -1 if unknown
+    std::vector<int> smt_siblings;  // Hardware threads of the same core,
+                                    // including this one
+};
+
+// What to ask cpu_topology::place() for
+struct placement_request {
+    size_t count{1};
+    // Only CPUs on this socket; -1 for whichever socket fits first
+    int socket{-1};
+    // At most one hardware thread per physical core
+    bool no_smt_siblings{true};
+    // Only CPUs sharing an L3 with this CPU; -1 for no constraint
+    int share_l3_with{-1};
+    // Only CPUs in the isolcpus/nohz_full sets
+    bool isolated_only{false};
+    // Only CPUs the current process is allowed to run on
+    bool allowed_only{true};
+};
+
+// CPU topology parsed from /sys/devices/system/cpu and /proc. Placement
+// results are plain CPU ids, ready for thread::set_core() or
+// thread_pool_options::cores.
+class cpu_topology {
+public:
+    // Reads the running system
+    cpu_topology();
+    // Reads <root>/sys/... and <root>/proc/... instead, for tests
+    explicit cpu_topology(std::string_view root);
+
+    // Online CPUs, ordered by id
+    const std::vector<cpu_info> &cpus() const noexcept { return m_cpus; }
+    // nullptr if the CPU doesn't exist or is offline
+    const cpu_info *cpu(int id) const noexcept;
+
+    std::vector<int> sockets() const;
+    std::vector<int> nodes() const;
+    std::vector<int> cpus_on_socket(int socket) const;
+    std::vector<int> cpus_on_node(int node) const;
+    // One CPU (the lowest-numbered thread) per physical core
+    std::vector<int> physical_cores() const;
+    // CPUs sharing the given cache level (2 or 3) with a CPU, including it
+    std::vector<int> sharing_cache(int cpu, int level) const;
+
+    // isolcpus= and nohz_full= CPU sets
+    const std::vector<int> &isolated() const noexcept { return m_isolated; }
+    const std::vector<int> &nohz_full() const noexcept { return m_nohz_full; }
+    bool is_isolated(int cpu) const noexcept;
+
+    // CPUs the current process may run on
+    const std::vector<int> &allowed() const noexcept { return m_allowed; }
+    bool is_allowed(int cpu) const noexcept;
+
+    // Picks request.count CPUs on one socket meeting the request, in id
+    // order. Returns an empty vector if that many can't be found.
+    std::vector<int> place(const placement_request &request) const;
+
+private:
+    void read_cpus();
+    void read_cpu_sets();
+    std::string read_line(const std::string &path) const;
+    std::vector<int> read_list(const std::string &path) const;
+
+    std::string m_root;
+    std::vector<cpu_info> m_cpus;
+    std::vector<int> m_isolated;
+    std::vector<int> m_nohz_full;
+    std::vector<int> m_allowed;
+};
+
+}  // namespace cpptools
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "cpptools/fixed_vector.hpp"
+
+namespace cpptools {
+
+// Sorted map of up to Capacity entries, with keys and values in two inline
+// arrays. Lookups are a branchless binary search over the keys alone, so
+// they touch few cache lines and the values only once found. Like
+// fixed_vector it holds no pointers and can be built in shared memory by
+// one process and searched in place by others. Zero-initialized memory is
+// an empty map.
+//
+// Inserting and erasing shift later entries, so it suits maps that are
+// built once and read often. Inserting into a full map throws
+// std::length_error.
+template <typename Key, typename T, size_t Capacity,
+          typename Compare = std::less<>>
+class fixed_flat_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = size_t;
+
+    // Value for key, nullptr if there is none. Any type Compare can order
+    // against Key works as a key, e.g. std::string_view for fixed_string.
+    template <typename K>
+    [[nodiscard]] T *find(const K &key) noexcept {
+        const size_t i = lower_bound(key);
+        return matches(i, key) ? &m_values[i] : nullptr;
+    }
+    template <typename K>
+    [[nodiscard]] const T *find(const K &key) const noexcept {
+        const size_t i = lower_bound(key);
+        return matches(i, key) ? &m_values[i] : nullptr;
+    }
+    template <typename K>
+    [[nodiscard]] bool contains(const K &key) const noexcept {
+        return find(key) != nullptr;
+    }
+
+    // Throws std::out_of_range if key isn't in the map
+    template <typename K>
+    [[nodiscard]] T &at(const K &key) {
+        return const_cast<T &>(std::as_const(*this).at(key));
+    }
+    template <typename K>
+    [[nodiscard]] const T &at(const K &key) const {
+        const T *value = find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("Key not found in fixed_flat_map");
+        }
+        return *value;
+    }
+
+    // Inserts value for key unless key is already there. Returns the value
+    // in the map and whether it was inserted.
+    template <typename K, typename V>
+    std::pair<T *, bool> insert(const K &key, V &&value) {
+        const size_t i = lower_bound(key);
+        if (matches(i, key)) {
+            return {&m_values[i], false};
+        }
+        check_room();
+        m_keys.emplace(m_keys.begin() + i, key);
+        m_values.emplace(m_values.begin() + i, std::forward<V>(value));
+        return {&m_values[i], true};
+    }
+
+    // Inserts or overwrites the value for key
+    template <typename K, typename V>
+    std::pair<T *, bool> insert_or_assign(const K &key, V &&value) {
+        if (T *existing = find(key)) {
+            *existing = std::forward<V>(value);
+            return {existing, false};
+        }
+        return insert(key, std::forward<V>(value));
+    }
+
+    // Returns whether key was in the map
+    template <typename K>
+    bool erase(const K &key) noexcept {
+        const size_t i = lower_bound(key);
+        if (!matches(i, key)) {
+            return false;
+        }
+        m_keys.erase(m_keys.begin() + i);
+        m_values.erase(m_values.begin() + i);
+        return true;
+    }
+
+    void clear() noexcept {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    // Entries in key order
+    [[nodiscard]] std::span<const Key> keys() const noexcept {
+        return {m_keys.data(), m_keys.size()};
+    }
+    [[nodiscard]] std::span<T> values() noexcept {
+        return {m_values.data(), m_values.size()};
+    }
+    [[nodiscard]] std::span<const T> values() const noexcept {
+        return {m_values.data(), m_values.size()};
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_keys.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_keys.empty(); }
+    [[nodiscard]] bool full() const noexcept { return m_keys.full(); }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+private:
+    // Index of the first key not less than key. The loop halves the range
+    // with a conditional move rather than a branch.
+    template <typename K>
+    size_t lower_bound(const K &key) const noexcept {
+        size_t n = m_keys.size();
+        if (n == 0) {
+            return 0;
+        }
+
+        const Key *base = m_keys.data();
+        while (n > 1) {
+            const size_t half = n / 2;
+            base = Compare{}(base[half - 1], key) ? base + half : base;
+            n -= half;
+        }
+        return (base - m_keys.data()) + (Compare{}(*base, key) ? 1 : 0);
+    }
+
+    template <typename K>
+    bool matches(size_t i, const K &key) const noexcept {
+        return i < m_keys.size() && !Compare{}(key, m_keys[i]);
+    }
+
+    void check_room() const {
+        if (full()) {
+            throw std::length_error(std::format(
+                "fixed_flat_map is full: capacity is {}", Capacity));
+        }
+    }
+
+    fixed_vector<Key, Capacity> m_keys;
+    fixed_vector<T, Capacity> m_values;
+};
+
+}  // namespace cpptools
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+
+namespace cpptools {
+
+// String of at most Capacity characters stored inline and always
+// null-terminated. Trivially copyable and position-independent, so it can
+// live in shared memory; zero-initialized memory is an empty string.
+//
+// Operations that would exceed Capacity throw std::length_error.
+template <size_t Capacity>
+class fixed_string {
+public:
+    fixed_string() noexcept = default;
+    explicit fixed_string(std::string_view str) { assign(str); }
+
+    fixed_string &operator=(std::string_view str) {
+        assign(str);
+        return *this;
+    }
+
+    void assign(std::string_view str) {
+        check_length(str.size());
+        std::memcpy(m_chars, str.data(), str.size());
+        m_size = str.size();
+        m_chars[m_size] = '\0';
+    }
+
+    fixed_string &append(std::string_view str) {
+        check_length(m_size + str.size());
+        std::memcpy(m_chars + m_size, str.data(), str.size());
+        m_size += str.size();
+        m_chars[m_size] = '\0';
+        return *this;
+    }
+    fixed_string &operator+=(std::string_view str) { return append(str); }
+    void push_back(char c) { append({&c, 1}); }
+
+    void clear() noexcept {
+        m_size = 0;
+        m_chars[0] = '\0';
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return {m_chars, m_size};
+    }
+    operator std::string_view() const noexcept { return view(); }
+
+    [[nodiscard]] const char *c_str() const noexcept { return m_chars; }
+    [[nodiscard]] const char *data() const noexcept { return m_chars; }
+    [[nodiscard]] char operator[](size_t i) const noexcept {
+        return m_chars[i];
+    }
+    [[nodiscard]] const char *begin() const noexcept { return m_chars; }
+    [[nodiscard]] const char *end() const noexcept { return m_chars + m_size; }
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] size_t length() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    friend bool operator==(const fixed_string &a,
+                           const fixed_string &b) noexcept {
+        return a.view() == b.view();
+    }
+    friend bool operator==(const fixed_string &a,
+                           std::string_view b) noexcept {
+        return a.view() == b;
+    }
+    friend std::strong_ordering operator<=>(const fixed_string &a,
+                                            const fixed_string &b) noexcept {
+        return a.view() <=> b.view();
+    }
+    friend std::strong_ordering operator<=>(const fixed_string &a,
+                                            std::string_view b) noexcept {
+        return a.view() <=> b;
+    }
+
+private:
+    void check_length(size_t length) const {
+        if (length > Capacity) {
+            throw std::length_error(
+                std::format("String of length {} doesn't fit in a "
+                            "fixed_string of capacity {}",
+                            length, Capacity));
+        }
+    }
+
+    size_t m_size{0};
+    char m_chars[Capacity + 1]{};
+};
+
+}  // namespace cpptools
+
+template <size_t Capacity>
+struct std::hash<cpptools::fixed_string<Capacity>> {
+    size_t operator()(
+        const cpptools::fixed_string<Capacity> &str) const noexcept {
+        return std::hash<std::string_view>{}(str.view());
+    }
+};
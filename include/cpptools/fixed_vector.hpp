@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace cpptools {
+
+// Vector with its elements stored inline, up to a fixed Capacity. It holds
+// no pointers, so it can live in shared memory and be read in place by
+// every attached process (as long as T can, see offset_ptr).
+// Zero-initialized memory is an empty fixed_vector, and it is trivially
+// copyable and destructible whenever T is.
+//
+// Operations that would exceed Capacity throw std::length_error.
+template <typename T, size_t Capacity>
+class fixed_vector {
+    static_assert(Capacity > 0, "Capacity must be greater than 0");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    fixed_vector() noexcept = default;
+    fixed_vector(std::initializer_list<T> items) {
+        for (const T &item : items) {
+            push_back(item);
+        }
+    }
+
+    fixed_vector(const fixed_vector &)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    fixed_vector(const fixed_vector &other) { *this = other; }
+
+    fixed_vector &operator=(const fixed_vector &)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    fixed_vector &operator=(const fixed_vector &other) {
+        if (this != &other) {
+            clear();
+            std::uninitialized_copy(other.begin(), other.end(), begin());
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    ~fixed_vector()
+        requires std::is_trivially_destructible_v<T>
+    = default;
+    ~fixed_vector() { clear(); }
+
+    [[nodiscard]] T &operator[](size_t i) noexcept { return data()[i]; }
+    [[nodiscard]] const T &operator[](size_t i) const noexcept {
+        return data()[i];
+    }
+    [[nodiscard]] T &at(size_t i) {
+        check_index(i);
+        return data()[i];
+    }
+    [[nodiscard]] const T &at(size_t i) const {
+        check_index(i);
+        return data()[i];
+    }
+    [[nodiscard]] T &front() noexcept { return data()[0]; }
+    [[nodiscard]] const T &front() const noexcept { return data()[0]; }
+    [[nodiscard]] T &back() noexcept { return data()[m_size - 1]; }
+    [[nodiscard]] const T &back() const noexcept { return data()[m_size - 1]; }
+
+    [[nodiscard]] T *data() noexcept {
+        return std::launder(reinterpret_cast<T *>(m_storage));
+    }
+    [[nodiscard]] const T *data() const noexcept {
+        return std::launder(reinterpret_cast<const T *>(m_storage));
+    }
+
+    [[nodiscard]] iterator begin() noexcept { return data(); }
+    [[nodiscard]] iterator end() noexcept { return data() + m_size; }
+    [[nodiscard]] const_iterator begin() const noexcept { return data(); }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return data() + m_size;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] bool full() const noexcept { return m_size == Capacity; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args) {
+        check_room();
+        T *item = std::construct_at(end(), std::forward<Args>(args)...);
+        ++m_size;
+        return *item;
+    }
+    void push_back(const T &item) { emplace_back(item); }
+    void push_back(T &&item) { emplace_back(std::move(item)); }
+
+    void pop_back() noexcept {
+        --m_size;
+        std::destroy_at(end());
+    }
+
+    // Inserts before pos, shifting later elements up by one
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        check_room();
+        const size_t index = pos - begin();
+        if (index == m_size) {
+            emplace_back(std::forward<Args>(args)...);
+        } else {
+            T item(std::forward<Args>(args)...);
+            std::construct_at(end(), std::move(back()));
+            std::move_backward(begin() + index, end() - 1, end());
+            data()[index] = std::move(item);
+            ++m_size;
+        }
+        return begin() + index;
+    }
+    iterator insert(const_iterator pos, const T &item) {
+        return emplace(pos, item);
+    }
+    iterator insert(const_iterator pos, T &&item) {
+        return emplace(pos, std::move(item));
+    }
+
+    // Removes the element at pos, shifting later elements down by one
+    iterator erase(const_iterator pos) noexcept {
+        const size_t index = pos - begin();
+        std::move(begin() + index + 1, end(), begin() + index);
+        pop_back();
+        return begin() + index;
+    }
+
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        m_size = 0;
+    }
+
+    friend bool operator==(const fixed_vector &a, const fixed_vector &b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+private:
+    void check_room() const {
+        if (m_size == Capacity) {
+            throw std::length_error(
+                std::format("fixed_vector is full: capacity is {}", Capacity));
+        }
+    }
+
+    void check_index(size_t i) const {
+        if (i >= m_size) {
+            throw std::out_of_range(std::format(
+                "fixed_vector index {} is out of range: size is {}", i,
+                m_size));
+        }
+    }
+
+    size_t m_size{0};
+    alignas(T) std::byte m_storage[Capacity * sizeof(T)];
+};
+
+}  // namespace cpptools
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <sched.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cpptools {
+
+// Startup settings for latency-critical threads. Defaults leave everything
+// as inherited.
+struct latency_profile {
+    // Scheduling policy (SCHED_OTHER, SCHED_FIFO, SCHED_RR, ...) and its
+    // static priority. Real-time policies need CAP_SYS_NICE or RLIMIT_RTPRIO.
+    int policy{SCHED_OTHER};
+    int priority{0};
+    bool set_scheduling{false};
+
+    // mlockall(MCL_CURRENT | MCL_FUTURE) for the whole process
+    bool lock_memory{false};
+
+    // Bytes of stack to touch up front, clamped to the thread's stack size
+    size_t stack_prefault{0};
+
+    // Timer slack in nanoseconds (PR_SET_TIMERSLACK); negative leaves it
+    long timer_slack_ns{-1};
+
+    // Check that every CPU the thread may run on is in the isolcpus or
+    // nohz_full set
+    bool require_isolated{false};
+
+    // Fail startup if any step fails, instead of running anyway
+    bool strict{false};
+};
+
+// What apply_latency_profile() actually put in place, read back from the
+// kernel where possible
+struct latency_report {
+    int policy{SCHED_OTHER};
+    int priority{0};
+    bool memory_locked{false};
+    size_t stack_prefaulted{0};
+    long timer_slack_ns{-1};
+    bool isolated{false};
+
+    // One message per step that failed
+    std::vector<std::string> errors;
+
+    bool ok() const noexcept { return errors.empty(); }
+};
+
+// Applies profile to the calling thread, attempting every step
+latency_report apply_latency_profile(const latency_profile &profile);
+
+}  // namespace cpptools
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+
+#include "cpptools/macros.hpp"
+
+namespace cpptools {
+
+// MCS queue lock: FIFO-fair, and each waiter spins on its own cache line.
+// Queue nodes come from a thread-local pool, so this mutex is in-process only
+// and must be unlocked by the thread that locked it. For a fair IPC mutex,
+// use ticket_mutex_ipc.
+class mcs_mutex {
+public:
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) node {
+        std::atomic<node *> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    mcs_mutex() = default;
+    ~mcs_mutex() = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(mcs_mutex);
+
+    void lock() noexcept;
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+
+private:
+    std::atomic<node *> tail_{nullptr};
+
+    // Queue node of the current owner - only accessed while holding the lock
+    node *holder_{nullptr};
+};
+
+}  // namespace cpptools
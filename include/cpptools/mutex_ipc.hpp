@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Places a mutex in POSIX shared memory for IPC. Mutex must be unlocked when
+// zero-initialized and must not depend on process-local addresses.
+template <typename Mutex>
+class mutex_ipc {
+    static_assert(std::is_standard_layout_v<Mutex>,
+                  "IPC mutex must have standard layout");
+
+public:
+    mutex_ipc() = delete;
+    mutex_ipc(std::string_view name)
+        : m_shmem(name, sizeof(Mutex)), m_mutex(m_shmem.as_struct<Mutex>()) {}
+    ~mutex_ipc() { m_mutex = nullptr; }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(mutex_ipc);
+
+    auto lock() { return m_mutex->lock(); }
+    auto try_lock() noexcept { return m_mutex->try_lock(); }
+    auto unlock() noexcept { return m_mutex->unlock(); }
+
+    // Shared ownership, for reader-writer mutexes
+    auto lock_shared()
+        requires requires(Mutex &m) { m.lock_shared(); }
+    {
+        return m_mutex->lock_shared();
+    }
+    auto try_lock_shared() noexcept
+        requires requires(Mutex &m) { m.try_lock_shared(); }
+    {
+        return m_mutex->try_lock_shared();
+    }
+    auto unlock_shared() noexcept
+        requires requires(Mutex &m) { m.unlock_shared(); }
+    {
+        return m_mutex->unlock_shared();
+    }
+
+    auto name() const { return m_shmem.name(); }
+    auto reference_count() const { return m_shmem.reference_count(); }
+
+private:
+    shared_memory m_shmem;
+    Mutex *m_mutex{nullptr};
+};
+
+}  // namespace cpptools
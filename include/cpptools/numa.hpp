@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace cpptools {
+
+// NUMA memory placement policy
+enum class numa_policy : uint8_t {
+    none,           // Kernel default: pages land on the node that first touches
+    bind,           // Allocate only on the given nodes
+    interleave,     // Interleave pages across the given nodes
+    local_to_core,  // Allocate only on the node of a given core
+};
+
+// NUMA helpers built on sysfs and the raw mbind/move_pages syscalls, so no
+// libnuma is needed. On kernels or machines without NUMA everything is
+// reported as node 0.
+namespace numa {
+
+// Parses a kernel list such as "0-3,8,10-11" into its members
+std::vector<int> parse_list(std::string_view list);
+
+// NUMA nodes that are online
+std::vector<int> online_nodes();
+
+// Node a CPU belongs to, or -1 if there is no such CPU
+int node_of_cpu(int cpu) noexcept;
+
+// Applies policy (bind or interleave) over nodes to the pages of
+// [addr, addr + len). With migrate, pages already faulted in elsewhere are
+// moved too. Returns 0 or an errno value.
+int bind_memory(void *addr, size_t len, numa_policy policy,
+                std::span<const int> nodes, bool migrate = false) noexcept;
+
+// Where the pages of a mapping currently reside
+struct residency {
+    std::vector<size_t> pages_per_node;  // Indexed by node
+    size_t not_present{0};               // Pages not faulted in yet
+};
+
+// Queries the node of every page in [addr, addr + len). Without NUMA
+// support every page counts as node 0; other failures throw
+// std::system_error.
+residency page_residency(void *addr, size_t len, size_t page_size);
+
+}  // namespace numa
+
+}  // namespace cpptools
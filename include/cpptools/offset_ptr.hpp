@@ -0,0 +1,127 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace cpptools {
+
+// Pointer stored as the distance from itself to its target, so it stays
+// valid wherever the memory holding both is mapped. Use it for pointers
+// between objects in the same shared memory segment; a pointer from a
+// segment to anywhere else is meaningless in other processes.
+//
+// Zero-initialized memory is a null offset_ptr (a pointer to itself can't
+// be represented, which no object needs). Copying recomputes the offset,
+// so offset_ptr isn't trivially copyable: copy it with its assignment
+// operator, never with memcpy.
+template <typename T>
+class offset_ptr {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::contiguous_iterator_tag;
+
+    offset_ptr() noexcept = default;
+    offset_ptr(std::nullptr_t) noexcept {}
+    offset_ptr(T *p) noexcept { set(p); }
+    offset_ptr(const offset_ptr &other) noexcept { set(other.get()); }
+
+    template <typename U>
+        requires std::is_convertible_v<U *, T *>
+    offset_ptr(const offset_ptr<U> &other) noexcept {
+        set(other.get());
+    }
+
+    offset_ptr &operator=(const offset_ptr &other) noexcept {
+        set(other.get());
+        return *this;
+    }
+    offset_ptr &operator=(T *p) noexcept {
+        set(p);
+        return *this;
+    }
+    offset_ptr &operator=(std::nullptr_t) noexcept {
+        m_offset = 0;
+        return *this;
+    }
+
+    [[nodiscard]] T *get() const noexcept {
+        if (m_offset == 0) {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(self() + m_offset);
+    }
+
+    T &operator*() const noexcept { return *get(); }
+    T *operator->() const noexcept { return get(); }
+    T &operator[](difference_type i) const noexcept { return get()[i]; }
+    explicit operator bool() const noexcept { return m_offset != 0; }
+
+    offset_ptr &operator+=(difference_type n) noexcept {
+        set(get() + n);
+        return *this;
+    }
+    offset_ptr &operator-=(difference_type n) noexcept {
+        set(get() - n);
+        return *this;
+    }
+    offset_ptr &operator++() noexcept { return *this += 1; }
+    offset_ptr &operator--() noexcept { return *this -= 1; }
+    offset_ptr operator++(int) noexcept {
+        offset_ptr tmp(*this);
+        ++*this;
+        return tmp;
+    }
+    offset_ptr operator--(int) noexcept {
+        offset_ptr tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    friend offset_ptr operator+(offset_ptr p, difference_type n) noexcept {
+        return p += n;
+    }
+    friend offset_ptr operator+(difference_type n, offset_ptr p) noexcept {
+        return p += n;
+    }
+    friend offset_ptr operator-(offset_ptr p, difference_type n) noexcept {
+        return p -= n;
+    }
+    friend difference_type operator-(const offset_ptr &a,
+                                     const offset_ptr &b) noexcept {
+        return a.get() - b.get();
+    }
+
+    friend bool operator==(const offset_ptr &a, const offset_ptr &b) noexcept {
+        return a.get() == b.get();
+    }
+    friend bool operator==(const offset_ptr &a, std::nullptr_t) noexcept {
+        return !a;
+    }
+    friend std::strong_ordering operator<=>(const offset_ptr &a,
+                                            const offset_ptr &b) noexcept {
+        return std::compare_three_way{}(a.get(), b.get());
+    }
+
+private:
+    uintptr_t self() const noexcept {
+        return reinterpret_cast<uintptr_t>(this);
+    }
+
+    void set(T *p) noexcept {
+        m_offset = p == nullptr ? 0
+                                : static_cast<difference_type>(
+                                      reinterpret_cast<uintptr_t>(p) - self());
+    }
+
+    difference_type m_offset{0};
+};
+
+}  // namespace cpptools
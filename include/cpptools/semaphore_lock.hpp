@@ -3,7 +3,9 @@
 #include <linux/limits.h>
 #include <semaphore.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -11,28 +13,103 @@
 
 namespace cpptools {
 
-// POSIX semaphore lock for IPC synchronization
+// How semaphore_lock::lock() acquires a permit
+enum class semaphore_mode : uint8_t {
+    try_once,         // sem_trywait: fail at once if no permit is free
+    blocking,         // sem_wait: sleep until a permit is free
+    timed,            // sem_clockwait on CLOCK_MONOTONIC, up to timeout
+    spin_then_block,  // Retry sem_trywait spin_budget times, then sem_wait
+};
+
+// Construction options for semaphore_lock
+struct semaphore_options {
+    // Permits of a new semaphore: how many semaphore_locks can hold it at
+    // once. Ignored when attaching to an existing one.
+    unsigned int permits{1};
+
+    semaphore_mode mode{semaphore_mode::try_once};
+
+    // For semaphore_mode::timed
+    std::chrono::nanoseconds timeout{std::chrono::seconds(1)};
+
+    // For semaphore_mode::spin_then_block: sem_trywait attempts, with
+    // backoff in between, before going to sleep
+    uint32_t spin_budget{64};
+};
+
+// POSIX semaphore lock for IPC synchronization. Each instance holds at most
+// one of the semaphore's permits.
 class semaphore_lock {
 public:
     // See "DESCRIPTION/Named semaphores" at
     // https://man7.org/linux/man-pages/man7/sem_overview.7.html
     static constexpr size_t MAX_SEMAPHORE_NAME_LEN = NAME_MAX - 4;
 
-    explicit semaphore_lock(std::string_view name);
+    explicit semaphore_lock(std::string_view name,
+                            const semaphore_options &options = {});
     ~semaphore_lock();
 
     CPPTOOLS_NO_COPY_OR_MOVE(semaphore_lock);
 
+    // Acquires a permit as options.mode says
     bool lock() noexcept;
     bool lock(int &err) noexcept;
 
+    // Acquire a permit whatever the mode: at once, or by a deadline
+    bool try_lock() noexcept;
+    bool lock_until(std::chrono::steady_clock::time_point deadline) noexcept;
+    bool lock_for(std::chrono::nanoseconds timeout) noexcept;
+
     bool unlock() noexcept;
     bool unlock(int &err) noexcept;
 
+    [[nodiscard]] bool owns_lock() const noexcept { return m_owned; }
+
+    // Permits currently free
+    [[nodiscard]] int available() const noexcept;
+
+    // Removes the named semaphore; instances already open keep working
+    static bool remove(std::string_view name) noexcept;
+
 private:
+    bool acquire(int &err) noexcept;
+    bool spin_then_wait(int &err) noexcept;
+    bool wait_until(std::chrono::steady_clock::time_point deadline,
+                    int &err) noexcept;
+    bool wait(int &err) noexcept;
+
     std::string m_name;
     sem_t *m_semaphore{nullptr};
+    semaphore_options m_options;
     bool m_owned{false};
 };
 
+// Holds a permit of a semaphore_lock for its lifetime, if it got one
+class semaphore_guard {
+public:
+    // Acquires as the lock's mode says
+    explicit semaphore_guard(semaphore_lock &lock) noexcept
+        : m_lock(lock), m_owned(lock.lock()) {}
+
+    // Waits for a permit until deadline
+    semaphore_guard(semaphore_lock &lock,
+                    std::chrono::steady_clock::time_point deadline) noexcept
+        : m_lock(lock), m_owned(lock.lock_until(deadline)) {}
+
+    ~semaphore_guard() {
+        if (m_owned) {
+            m_lock.unlock();
+        }
+    }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(semaphore_guard);
+
+    [[nodiscard]] bool owns_lock() const noexcept { return m_owned; }
+    explicit operator bool() const noexcept { return m_owned; }
+
+private:
+    semaphore_lock &m_lock;
+    bool m_owned;
+};
+
 }  // namespace cpptools
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "cpptools/backoff.hpp"
+#include "cpptools/macros.hpp"
+
+namespace cpptools {
+
+// Publishes a small trivially copyable T from writers to any number of
+// readers. A write makes the sequence number odd, copies the value in and
+// makes it even again; a read copies the value out and retries if the
+// sequence was odd or moved meanwhile. Readers never write shared memory,
+// so they don't slow each other or the writer down, and writers never wait
+// for readers (concurrent writers do take turns).
+//
+// The value is kept as an array of atomic words, copied with relaxed
+// atomic loads and stores, so torn copies are discarded without a data
+// race. Holds no pointers: place it in shared memory with
+// shared_memory::as_struct<seqlock<T>>(), where zero-initialized memory
+// reads as an all-zero T.
+template <typename T>
+class seqlock {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "seqlock values must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+
+public:
+    static constexpr size_t DEFAULT_MAX_RETRIES = 64;
+
+    seqlock() noexcept = default;
+    explicit seqlock(const T &value) noexcept { store(value); }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(seqlock);
+
+    void write(const T &value) noexcept {
+        // Claim the sequence from other writers by making it odd
+        backoff b;
+        uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        while ((seq & 1) != 0 ||
+               !m_seq.compare_exchange_weak(seq, seq + 1,
+                                            std::memory_order_relaxed)) {
+            b.pause_or_yield();
+            seq = m_seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        store(value);
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Returns false, leaving value unchanged, if every one of max_retries
+    // attempts overlapped a write
+    [[nodiscard]] bool try_read(
+        T &value, size_t max_retries = DEFAULT_MAX_RETRIES) const noexcept {
+        backoff b;
+        for (size_t attempt = 0; attempt < max_retries; ++attempt) {
+            if (read_once(value)) {
+                return true;
+            }
+            b.pause();
+        }
+        return false;
+    }
+
+    // Retries until it gets a consistent copy
+    [[nodiscard]] T read() const noexcept {
+        T value;
+        backoff b;
+        while (!read_once(value)) {
+            b.pause_or_yield();
+        }
+        return value;
+    }
+
+    // Number of completed writes
+    [[nodiscard]] uint64_t version() const noexcept {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    void store(const T &value) noexcept {
+        uint64_t words[WORDS]{};
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    bool read_once(T &value) const noexcept {
+        const uint64_t before = m_seq.load(std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            return false;
+        }
+
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint64_t> m_seq{0};
+    std::atomic<uint64_t> m_words[WORDS]{};
+};
+
+}  // namespace cpptools
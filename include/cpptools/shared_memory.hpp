@@ -1,27 +1,137 @@
 #pragma once
 
 #include <linux/limits.h>
+#include <sys/mman.h>
+#include <sys/types.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "cpptools/macros.hpp"
-#include "cpptools/semaphore_lock.hpp"
+#include "cpptools/numa.hpp"
 
 namespace cpptools {
 
-// Class for managing POSIX shared memory
+// Page size backing a shared memory segment
+enum class page_size : uint8_t {
+    normal,    // Kernel default page size, 4 KiB on x86-64
+    huge_2mb,  // 2 MiB huge pages
+    huge_1gb,  // 1 GiB huge pages
+};
+
+// Construction options for shared_memory
+struct shared_memory_options {
+    // Huge pages are allocated through a hugetlbfs mount with a matching page
+    // size, and the segment size is rounded up to a whole number of pages. If
+    // there is no such mount or not enough free huge pages, the segment falls
+    // back to normal pages and shared_memory::fallback_reason() says why.
+    // Every process attaching to a segment must request the same page size.
+    page_size pages{page_size::normal};
+
+    // hugetlbfs mount point for huge pages. If empty, a mount with the
+    // requested page size is looked up in /proc/mounts.
+    std::string hugetlbfs_mount;
+
+    // Page-in options, applied on every attach so that the first access to
+    // each page doesn't take a page fault:
+    // - populate: map with MAP_POPULATE
+    // - prefault: write-fault every page after mapping, without changing its
+    //   contents (MADV_POPULATE_WRITE, or an atomic no-op write per page on
+    //   kernels without it)
+    // - lock_pages: mlock() the mapping so it can't be swapped or reclaimed
+    // - advice: madvise() advice for the mapping, e.g. MADV_WILLNEED or
+    //   MADV_RANDOM
+    bool populate{false};
+    bool prefault{false};
+    bool lock_pages{false};
+    int advice{MADV_NORMAL};
+
+    // NUMA placement of the segment's pages, applied with mbind() right
+    // after mapping and before any page-in step (populate is then done with
+    // MADV_POPULATE_WRITE instead of MAP_POPULATE). bind and interleave use
+    // numa_nodes, local_to_core uses the node of numa_core. Nodes that aren't
+    // online are dropped, and if none are left the policy is skipped; see
+    // shared_memory::numa_fallback_reason().
+    numa_policy numa{numa_policy::none};
+    std::vector<int> numa_nodes;
+    int numa_core{-1};
+
+    // Growable segments: if nonzero, address space for up to max_size bytes
+    // is reserved on every attach, so that shared_memory::grow() can extend
+    // the segment in place without moving it. A segment that has been grown
+    // can be attached with any requested size up to its current one, and
+    // attached processes map the new bytes with shared_memory::refresh().
+    size_t max_size{0};
+
+    // How long to wait for another process that is creating the segment,
+    // or destroying it, before giving up with std::runtime_error. A creator
+    // that died mid-way is noticed sooner: its segment is removed and
+    // created afresh.
+    std::chrono::nanoseconds attach_timeout{std::chrono::seconds(5)};
+};
+
+// Time spent in each attach step of a shared_memory, zero for steps that
+// weren't requested
+struct shared_memory_timings {
+    std::chrono::nanoseconds map{0};
+    std::chrono::nanoseconds numa{0};
+    std::chrono::nanoseconds advise{0};
+    std::chrono::nanoseconds prefault{0};
+    std::chrono::nanoseconds lock{0};
+};
+
+// Tag for the constructors of anonymous, memfd-backed shared_memory
+struct memfd_t {
+    explicit memfd_t() = default;
+};
+inline constexpr memfd_t memfd{};
+
+// Class for managing shared memory: named POSIX segments, or anonymous
+// memfd segments that are shared by passing their file descriptor
 class shared_memory {
     static constexpr size_t REF_COUNT_OFFSET = CPPTOOLS_CACHELINE_SIZE;
 
+    // Set by the process that creates a segment, once it's usable
+    enum class init_state : uint32_t { initializing, ready, failed };
+
+    // Bookkeeping at the start of the mapping, before the data
+    struct header {
+        int reference_count;
+        uint32_t grow_lock;   // Held by grow()
+        uint64_t generation;  // Bumped by every grow()
+        uint64_t data_size;   // Set by grow(), zero until then
+        init_state state;
+        pid_t creator;  // Set before state leaves initializing, 0 until then
+    };
+    static_assert(sizeof(header) <= REF_COUNT_OFFSET);
+
 public:
     // See "DESCRIPTION" at
     // https://man7.org/linux/man-pages/man3/shm_open.3.html
     static constexpr size_t MAX_NAME_LEN = NAME_MAX;
 
-    shared_memory(std::string_view shMemName, size_t requestedSize);
+    shared_memory(std::string_view shMemName, size_t requestedSize,
+                  const shared_memory_options &options = {});
+
+    // Anonymous segment created with memfd_create(): no global name to
+    // collide or leak. It lives until its last descriptor
+    // and mapping are gone. Other processes attach through fd(), inherited
+    // across fork() or sent with send_fd(); the descriptor is close-on-exec.
+    // name is only a label, shown in /proc/<pid>/fd.
+    shared_memory(memfd_t, std::string_view name, size_t requestedSize,
+                  const shared_memory_options &options = {});
+
+    // Attaches to an anonymous segment through a descriptor of it, which is
+    // duplicated: the caller still owns fd. Huge pages are used if the
+    // segment has them, whatever options.pages says.
+    shared_memory(memfd_t, int fd, size_t requestedSize,
+                  const shared_memory_options &options = {});
+
     ~shared_memory();
 
     // No default/copy/move construction
@@ -45,10 +155,10 @@ public:
         T *data{nullptr};
         size_t size{0};
 
-        // Make sure that m_Data is mapped
+        // Make sure that m_Data is mapped, and count whole elements of type T
         if (m_data) {
             data = reinterpret_cast<T *>(m_data);
-            size = m_data_size;
+            size = m_data_size / sizeof(T);
         }
 
         return std::span<T>(data, size);
@@ -59,23 +169,123 @@ public:
     [[nodiscard]] size_t size() const { return m_data_size; }
     [[nodiscard]] int reference_count() const;
 
+    // Growable segments, see shared_memory_options::max_size
+
+    // Grows the segment to at least new_size bytes of data, in place, so
+    // pointers into it stay valid. Returns false, without growing, if
+    // another process is growing it at the same time.
+    // Throws std::logic_error if the segment isn't growable, and
+    // std::length_error if new_size is over max_size.
+    bool grow(size_t new_size);
+
+    // Maps whatever other processes have grown the segment by, and returns
+    // whether size() changed. Cheap when nothing did: one atomic load.
+    bool refresh();
+
+    [[nodiscard]] bool growable() const { return m_reserved_size != 0; }
+    [[nodiscard]] size_t max_size() const { return m_options.max_size; }
+
+    // Number of times the segment has been grown
+    [[nodiscard]] uint64_t generation() const;
+
+    // Size of the pages backing the segment, and whether they are huge pages
+    [[nodiscard]] size_t page_bytes() const { return m_page_size; }
+    [[nodiscard]] bool huge_pages() const { return m_huge_pages; }
+
+    // Whether the segment is memfd-backed, and its descriptor
+    [[nodiscard]] bool anonymous() const { return m_anonymous; }
+    [[nodiscard]] int fd() const { return m_file_desc; }
+
+    // Adds F_SEAL_* seals to an anonymous segment, e.g. F_SEAL_SHRINK |
+    // F_SEAL_GROW to fix its size. Throws std::system_error on failure.
+    void seal(int seals);
+
+    // Seals in place. Named segments report F_SEAL_SEAL: they can't be
+    // sealed.
+    [[nodiscard]] int seals() const;
+
+    // How long each step of mapping the segment, or its latest growth, took
+    [[nodiscard]] const shared_memory_timings &attach_timings() const {
+        return m_timings;
+    }
+
+    // Why huge pages were requested but not used; empty otherwise
+    [[nodiscard]] const std::string &fallback_reason() const {
+        return m_fallback_reason;
+    }
+
+    // NUMA nodes the segment is placed on, empty if no policy was applied
+    [[nodiscard]] const std::vector<int> &numa_nodes() const {
+        return m_numa_nodes;
+    }
+
+    // Why the requested NUMA policy was changed or skipped; empty otherwise
+    [[nodiscard]] const std::string &numa_fallback_reason() const {
+        return m_numa_fallback_reason;
+    }
+
+    // Where the segment's pages currently reside, see numa::page_residency()
+    [[nodiscard]] numa::residency numa_residency() const;
+
 private:
-    bool open_shared_mem_file(std::string_view name);
-    void close_shared_mem_file() noexcept;
+    void select_huge_pages(std::string_view name,
+                           const shared_memory_options &options);
 
-    void alloc_shared_mem(std::string_view name);
+    int open_file(std::string_view name, int flags) const noexcept;
+    int unlink_file() const noexcept;
+
+    void check_existing_size(std::string_view name, int file_desc);
+    void close_shared_mem_file() noexcept;
     void free_shared_mem() noexcept;
 
     void map_shared_mem(std::string_view name = {});
+    void map_growth(size_t total_size);
+    size_t grown_size();
     void unmap_shared_mem() noexcept;
 
+    bool lock_growth() noexcept;
+    void unlock_growth() noexcept;
+
+    using time_point = std::chrono::steady_clock::time_point;
+
+    void create_or_attach(std::string_view name);
+    bool wait_for_size(std::string_view name, time_point deadline);
+    bool attach(std::string_view name, bool creator, time_point deadline);
+    init_state wait_until_initialized(time_point deadline) const noexcept;
+    bool creator_died() const noexcept;
+    time_point attach_deadline() const;
+    void detach() noexcept;
+
+    void apply_numa_policy(std::string_view name);
+    void page_in(std::string_view name, std::byte *addr, size_t len);
+    void prefault_pages(std::string_view name, std::byte *addr, size_t len);
+
     std::string m_name;
-    int *m_reference_count{nullptr};
+    header *m_header{nullptr};
     void *m_data{nullptr};
-    const size_t m_data_size;
-    const size_t m_total_size;
+    size_t m_data_size;
+    size_t m_total_size;
+    size_t m_reserved_size{0};
+    uint64_t m_generation{0};  // Last generation mapped
+    size_t m_page_size;
+    std::string m_path;  // hugetlbfs file path, empty for POSIX shared memory
+    bool m_huge_pages{false};
+    std::string m_fallback_reason;
+    std::vector<int> m_numa_nodes;
+    std::string m_numa_fallback_reason;
+    shared_memory_options m_options;
+    shared_memory_timings m_timings;
     int m_file_desc{-1};
-    semaphore_lock m_semlock;
+    bool m_anonymous{false};  // memfd-backed
 };
 
+// Passes a file descriptor, e.g. shared_memory::fd(), to another process
+// over a connected Unix domain socket. Throws std::system_error on failure.
+void send_fd(int socket, int fd);
+
+// Receives a file descriptor sent with send_fd(), close-on-exec. The caller
+// owns it. Throws std::system_error on failure, or std::runtime_error if the
+// peer closed the socket.
+int receive_fd(int socket);
+
 }  // namespace cpptools
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "cpptools/macros.hpp"
+
+#ifndef CPPTOOLS_RW_READER_SLOTS
+#define CPPTOOLS_RW_READER_SLOTS 16
+#endif
+
+namespace cpptools {
+
+// Reader-writer spinlock for read-mostly data. Readers register in one of
+// several per-core counters, each on its own cache line, so concurrent
+// readers don't write a shared line. A waiting writer blocks new readers, so
+// writers can't be starved. Valid when zero-initialized, so it can be placed
+// in shared memory (see shared_spinlock_mutex_ipc).
+class shared_spinlock_mutex {
+public:
+    static constexpr size_t READER_SLOTS = CPPTOOLS_RW_READER_SLOTS;
+
+    shared_spinlock_mutex() = default;
+    ~shared_spinlock_mutex() = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shared_spinlock_mutex);
+
+    // Exclusive ownership
+    void lock() noexcept;
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+
+    // Shared ownership
+    void lock_shared() noexcept;
+    bool try_lock_shared() noexcept;
+    void unlock_shared() noexcept;
+
+private:
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) reader_slot {
+        std::atomic<uint32_t> count{0};
+    };
+
+    bool readers_drained() const noexcept;
+
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> writer_{0};
+    reader_slot readers_[READER_SLOTS];
+};
+
+}  // namespace cpptools
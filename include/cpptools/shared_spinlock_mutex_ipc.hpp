@@ -0,0 +1,11 @@
+#pragma once
+
+#include "cpptools/mutex_ipc.hpp"
+#include "cpptools/shared_spinlock_mutex.hpp"
+
+namespace cpptools {
+
+// Reader-writer spinlock for IPC via POSIX shared memory
+using shared_spinlock_mutex_ipc = mutex_ipc<shared_spinlock_mutex>;
+
+}  // namespace cpptools
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Result of shm_broadcast_ring::read()
+enum class broadcast_status : uint8_t {
+    ok,       // A message was read
+    empty,    // Nothing new since the last message
+    overrun,  // The writer lapped this reader, which skipped to the latest
+};
+
+// One-writer/many-reader broadcast ring of variable-length messages in
+// POSIX shared memory. The writer never waits for readers: each reader
+// keeps its own position, reads in place at its own pace, and finds out if
+// the writer overwrote what it was about to read.
+//
+// Messages are stored back to back as records, each a 16-byte header
+// followed by the payload, padded to 16 bytes. Positions are byte offsets
+// that only grow. A record's header carries its stamp, position + 1,
+// written last, so a reader knows the record at its position is complete
+// when the stamp matches. Before writing, the writer moves its claim
+// cursor past the bytes it is about to overwrite; a reader whose position
+// has fallen a whole ring behind the claim cursor has been overrun. The
+// header after the newest record is kept cleared, so stale bytes there
+// never look like a complete record.
+//
+// Only one process may write at a time. Zero-initialized shared memory is
+// an empty ring.
+template <size_t Capacity>
+class shm_broadcast_ring {
+    static_assert(Capacity >= 64 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2 of at least 64");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    static constexpr uint64_t MASK = Capacity - 1;
+    static constexpr uint64_t ALIGN = 16;
+
+    struct record {
+        std::atomic<uint64_t> stamp;  // Position + 1, zero if never written
+        std::atomic<uint32_t> size;   // Payload bytes
+        std::atomic<uint32_t> skip;   // Nonzero for padding at the ring end
+    };
+    static_assert(sizeof(record) == ALIGN);
+
+    struct layout {
+        // Bytes before claim may be being overwritten
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint64_t> claim;
+        // Every record before cursor is complete
+        std::atomic<uint64_t> cursor;
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::byte data[Capacity];
+    };
+
+    static constexpr uint64_t align_up(uint64_t n) noexcept {
+        return (n + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+public:
+    shm_broadcast_ring() = delete;
+    // Readers start at the latest position, seeing only messages written
+    // from now on
+    explicit shm_broadcast_ring(std::string_view name)
+        : m_shmem(name, sizeof(layout)), m_ring(m_shmem.as_struct<layout>()) {
+        m_write_pos = m_ring->cursor.load(std::memory_order_acquire);
+        m_read_pos = m_write_pos;
+    }
+    ~shm_broadcast_ring() { m_ring = nullptr; }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shm_broadcast_ring);
+
+    // Largest payload a single message can carry
+    [[nodiscard]] static constexpr size_t max_message_size() noexcept {
+        return Capacity / 4 - sizeof(record);
+    }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    // Writer
+
+    // Reserves room for a message of size bytes and returns it for the
+    // caller to fill in place, then commit(). Returns an empty span if size
+    // is over max_message_size().
+    [[nodiscard]] std::span<std::byte> prepare(size_t size) noexcept {
+        if (size > max_message_size()) {
+            return {};
+        }
+
+        uint64_t pos = m_write_pos;
+        const uint64_t total = sizeof(record) + align_up(size);
+
+        // Records don't wrap: pad out the end of the ring instead. The claim
+        // also covers the next record's header, cleared below.
+        const uint64_t room = Capacity - (pos & MASK);
+        const uint64_t padding = room < total ? room : 0;
+        claim(pos + padding + total + sizeof(record));
+
+        if (padding != 0) {
+            record &pad = record_at(pos);
+            pad.size.store(padding - sizeof(record), std::memory_order_relaxed);
+            pad.skip.store(1, std::memory_order_relaxed);
+            record_at(pos + padding).stamp.store(0, std::memory_order_relaxed);
+            pad.stamp.store(pos + 1, std::memory_order_release);
+            pos += padding;
+        }
+
+        record &r = record_at(pos);
+        r.size.store(size, std::memory_order_relaxed);
+        r.skip.store(0, std::memory_order_relaxed);
+
+        // Whatever the ring held after this record is stale: clear the
+        // stamp there, so that a reader arriving before the next commit
+        // can't mistake old bytes for a record
+        record_at(pos + total).stamp.store(0, std::memory_order_relaxed);
+
+        m_pending_pos = pos;
+        m_pending_end = pos + total;
+        return {payload_at(pos), size};
+    }
+
+    // Publishes the message from the last prepare()
+    void commit() noexcept {
+        record_at(m_pending_pos)
+            .stamp.store(m_pending_pos + 1, std::memory_order_release);
+        m_ring->cursor.store(m_pending_end, std::memory_order_release);
+        m_write_pos = m_pending_end;
+    }
+
+    // Copies msg in and publishes it. Returns false if it's too large.
+    bool publish(std::span<const std::byte> msg) noexcept {
+        const std::span<std::byte> buffer = prepare(msg.size());
+        if (buffer.size() != msg.size()) {
+            return false;
+        }
+        std::memcpy(buffer.data(), msg.data(), msg.size());
+        commit();
+        return true;
+    }
+
+    // Reader
+
+    // Calls f(std::span<const std::byte>) with the next message, in place.
+    // The span is only valid during the call. If the writer overwrote the
+    // message while f was reading it, returns overrun: whatever f made of
+    // it must be thrown away, and the reader has moved to the latest
+    // position.
+    template <typename F>
+    broadcast_status read(F &&f) {
+        while (true) {
+            if (overrun()) {
+                return recover();
+            }
+
+            const record &r = record_at(m_read_pos);
+            if (r.stamp.load(std::memory_order_acquire) != m_read_pos + 1) {
+                // Not written yet, unless the writer lapped us meanwhile
+                return overrun() ? recover() : broadcast_status::empty;
+            }
+
+            const uint32_t size = r.size.load(std::memory_order_relaxed);
+            const bool skip = r.skip.load(std::memory_order_relaxed) != 0;
+            if (overrun()) {
+                return recover();
+            }
+
+            if (skip) {
+                m_read_pos += sizeof(record) + size;
+                continue;
+            }
+
+            f(std::span<const std::byte>(payload_at(m_read_pos), size));
+            if (overrun()) {
+                return recover();
+            }
+
+            m_read_pos += sizeof(record) + align_up(size);
+            return broadcast_status::ok;
+        }
+    }
+
+    // Skips everything already written, to read only newer messages
+    void seek_latest() noexcept {
+        m_read_pos = m_ring->cursor.load(std::memory_order_acquire);
+    }
+
+    // Bytes written that this reader hasn't read yet
+    [[nodiscard]] uint64_t lag() const noexcept {
+        return m_ring->cursor.load(std::memory_order_acquire) - m_read_pos;
+    }
+
+    // Times this reader was overrun
+    [[nodiscard]] uint64_t overruns() const noexcept { return m_overruns; }
+
+    auto name() const { return m_shmem.name(); }
+    auto reference_count() const { return m_shmem.reference_count(); }
+
+private:
+    record &record_at(uint64_t pos) const noexcept {
+        return *reinterpret_cast<record *>(&m_ring->data[pos & MASK]);
+    }
+
+    std::byte *payload_at(uint64_t pos) const noexcept {
+        return &m_ring->data[(pos & MASK) + sizeof(record)];
+    }
+
+    // Announces that bytes up to end - Capacity are about to be overwritten
+    void claim(uint64_t end) noexcept {
+        m_ring->claim.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Whether anything from the read position on may have been overwritten
+    bool overrun() const noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_ring->claim.load(std::memory_order_relaxed) >
+               m_read_pos + Capacity;
+    }
+
+    broadcast_status recover() noexcept {
+        ++m_overruns;
+        seek_latest();
+        return broadcast_status::overrun;
+    }
+
+    shared_memory m_shmem;
+    layout *m_ring{nullptr};
+
+    // Writer state, local to this process
+    uint64_t m_write_pos{0};
+    uint64_t m_pending_pos{0};
+    uint64_t m_pending_end{0};
+
+    // Reader state, local to this process
+    uint64_t m_read_pos{0};
+    uint64_t m_overruns{0};
+};
+
+}  // namespace cpptools
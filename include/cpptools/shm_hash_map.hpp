@@ -0,0 +1,364 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "cpptools/backoff.hpp"
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Result of shm_hash_map::try_find()
+enum class lookup_status : uint8_t {
+    found,
+    missing,
+    busy,  // Every attempt at a group overlapped a write
+};
+
+// Fixed-capacity open-addressing hash map in POSIX shared memory, for
+// lookup tables shared by many processes.
+//
+// Slots are split into groups of 16, each with 16 control bytes (empty,
+// deleted, or 7 bits of the key's hash) that are matched against a lookup
+// with one SIMD compare. Keys probe linearly group by group from their
+// home group, and stop at the first group with an empty slot.
+//
+// Lookups never write shared memory: every group carries a seqlock
+// version that writers make odd while they change the group, and a lookup
+// copies the group's control bytes and candidate entries, then retries if
+// the version moved. Writers don't block readers and only serialize with
+// other writers: an insert, update or erase holds the stripe lock of the
+// key's home group (so one key is only ever written by one writer at a
+// time) and the write lock of each group it touches, for a few stores.
+//
+// Keys and values must be trivially copyable; zero-initialized shared
+// memory is an empty map. A writer that dies while holding a lock leaves
+// that group locked: find() waits on it forever, and try_find() reports it
+// as busy.
+template <typename Key, typename Value, size_t Capacity,
+          typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<>>
+class shm_hash_map {
+    static_assert(std::is_trivially_copyable_v<Key>,
+                  "Keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<Value>,
+                  "Values must be trivially copyable");
+
+public:
+    static constexpr size_t GROUP_SIZE = 16;
+
+private:
+    static_assert(Capacity >= GROUP_SIZE && std::has_single_bit(Capacity),
+                  "Capacity must be a power of 2 of at least 16");
+
+    static constexpr size_t NUM_GROUPS = Capacity / GROUP_SIZE;
+
+    // Control bytes: zero is empty, so that zeroed memory is an empty map
+    static constexpr uint8_t EMPTY = 0x00;
+    static constexpr uint8_t DELETED = 0x01;
+    static constexpr uint8_t FULL = 0x80;  // | top 7 bits of the hash
+
+    struct slot {
+        Key key;
+        Value value;
+    };
+
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) group {
+        std::atomic<uint32_t> version;  // Odd while being written
+        std::atomic<uint32_t> writer;   // Held while writing this group
+        std::atomic<uint32_t> stripe;   // Held by writers of keys homed here
+        uint8_t ctrl[GROUP_SIZE];
+        slot slots[GROUP_SIZE];
+    };
+
+    struct layout {
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> size;
+        group groups[NUM_GROUPS];
+    };
+
+public:
+    shm_hash_map() = delete;
+    explicit shm_hash_map(std::string_view name)
+        : m_shmem(name, sizeof(layout)), m_map(m_shmem.as_struct<layout>()) {}
+    ~shm_hash_map() { m_map = nullptr; }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shm_hash_map);
+
+    static constexpr size_t DEFAULT_MAX_RETRIES = 64;
+
+    // Copy of the value for key, if any. Waits for writers of the groups it
+    // reads; try_find() bounds the wait.
+    [[nodiscard]] std::optional<Value> find(const Key &key) const noexcept {
+        alignas(Value) std::byte buf[sizeof(Value)];
+        if (lookup(key, buf, std::numeric_limits<size_t>::max()) !=
+            lookup_status::found) {
+            return std::nullopt;
+        }
+        return std::bit_cast<Value>(buf);
+    }
+
+    // Copies the value for key to value, which is left unchanged unless key
+    // is found. Returns busy if max_retries attempts at one group all
+    // overlapped a write.
+    [[nodiscard]] lookup_status try_find(
+        const Key &key, Value &value,
+        size_t max_retries = DEFAULT_MAX_RETRIES) const noexcept {
+        alignas(Value) std::byte buf[sizeof(Value)];
+        const lookup_status status = lookup(key, buf, max_retries);
+        if (status == lookup_status::found) {
+            value = std::bit_cast<Value>(buf);
+        }
+        return status;
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const noexcept {
+        return find(key).has_value();
+    }
+
+    // Inserts key, or overwrites its value if it's already there. Returns
+    // false only if the map is full.
+    bool insert_or_assign(const Key &key, const Value &value) noexcept {
+        const size_t hash = mix(Hash{}(key));
+        const auto tag = static_cast<uint8_t>(FULL | (hash >> 57));
+        group &home = group_at(hash);
+        lock(home.stripe);
+
+        // Update in place if key is already in its probe sequence
+        bool done = for_each_group(hash, [&](group &g) {
+            for (uint32_t m = match(g.ctrl, tag); m != 0; m &= m - 1) {
+                slot &s = g.slots[std::countr_zero(m)];
+                if (KeyEqual{}(s.key, key)) {
+                    write_begin(g);
+                    copy(&s.value, &value, sizeof(Value));
+                    write_end(g);
+                    return stop::done;
+                }
+            }
+            return match(g.ctrl, EMPTY) != 0 ? stop::missing : stop::next;
+        });
+
+        // Otherwise take the first free slot from the home group on
+        if (!done) {
+            done = for_each_group(hash, [&](group &g) {
+                const uint32_t free =
+                    match(g.ctrl, EMPTY) | match(g.ctrl, DELETED);
+                if (free == 0) {
+                    return stop::next;
+                }
+                const size_t i = std::countr_zero(free);
+                write_begin(g);
+                copy(&g.slots[i].key, &key, sizeof(Key));
+                copy(&g.slots[i].value, &value, sizeof(Value));
+                store_ctrl(g, i, tag);
+                write_end(g);
+                m_map->size.fetch_add(1, std::memory_order_relaxed);
+                return stop::done;
+            });
+        }
+
+        unlock(home.stripe);
+        return done;
+    }
+
+    // Returns whether key was in the map
+    bool erase(const Key &key) noexcept {
+        const size_t hash = mix(Hash{}(key));
+        const auto tag = static_cast<uint8_t>(FULL | (hash >> 57));
+        group &home = group_at(hash);
+        lock(home.stripe);
+
+        const bool erased = for_each_group(hash, [&](group &g) {
+            for (uint32_t m = match(g.ctrl, tag); m != 0; m &= m - 1) {
+                const size_t i = std::countr_zero(m);
+                if (KeyEqual{}(g.slots[i].key, key)) {
+                    // A group that has never been full has an empty slot,
+                    // and no probe sequence passes through it, so the slot
+                    // can go straight back to empty
+                    const bool was_full = match(g.ctrl, EMPTY) == 0;
+                    write_begin(g);
+                    store_ctrl(g, i, was_full ? DELETED : EMPTY);
+                    write_end(g);
+                    m_map->size.fetch_sub(1, std::memory_order_relaxed);
+                    return stop::done;
+                }
+            }
+            return match(g.ctrl, EMPTY) != 0 ? stop::missing : stop::next;
+        });
+
+        unlock(home.stripe);
+        return erased;
+    }
+
+    // Approximate while writers are active
+    [[nodiscard]] size_t size() const noexcept {
+        return m_map->size.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    auto name() const { return m_shmem.name(); }
+    auto reference_count() const { return m_shmem.reference_count(); }
+
+private:
+    enum class stop { next, missing, done };
+
+    // Spreads the hash over all bits: group index from the low bits, control
+    // tag from the top 7
+    static size_t mix(size_t h) noexcept {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Bit i set for every control byte equal to value
+    static uint32_t match(const uint8_t *ctrl, uint8_t value) noexcept {
+#if defined(__SSE2__)
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        return _mm_movemask_epi8(
+            _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value))));
+#else
+        uint32_t mask{0};
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= uint32_t{ctrl[i] == value} << i;
+        }
+        return mask;
+#endif
+    }
+
+    // memcpy of memory that a writer may be changing. The seqlock check
+    // afterwards throws away anything torn.
+    static void copy(void *dst, const void *src, size_t n) noexcept {
+        std::memcpy(dst, src, n);
+    }
+
+    // Copies the value for key to out, giving up on a group after
+    // max_retries attempts that overlapped a write. Candidates are copied
+    // as bytes, so neither Key nor Value has to be default-constructible.
+    lookup_status lookup(const Key &key, std::byte *out,
+                         size_t max_retries) const noexcept {
+        const size_t hash = mix(Hash{}(key));
+        const auto tag = static_cast<uint8_t>(FULL | (hash >> 57));
+
+        for (size_t i = 0; i < NUM_GROUPS; ++i) {
+            const group &g = group_at(hash + i);
+
+            backoff b;
+            for (size_t attempt = 0;; ++attempt) {
+                if (attempt == max_retries) {
+                    return lookup_status::busy;
+                }
+
+                const uint32_t version =
+                    g.version.load(std::memory_order_acquire);
+                if (version & 1) {
+                    b.pause_or_yield();
+                    continue;
+                }
+
+                uint8_t ctrl[GROUP_SIZE];
+                copy(ctrl, g.ctrl, sizeof(ctrl));
+
+                bool found{false};
+                for (uint32_t m = match(ctrl, tag); m != 0; m &= m - 1) {
+                    const slot &s = g.slots[std::countr_zero(m)];
+                    alignas(Key) std::byte candidate[sizeof(Key)];
+                    copy(candidate, &s.key, sizeof(Key));
+                    if (KeyEqual{}(std::bit_cast<Key>(candidate), key)) {
+                        copy(out, &s.value, sizeof(Value));
+                        found = true;
+                        break;
+                    }
+                }
+                const bool last = match(ctrl, EMPTY) != 0;
+
+                if (!read_retry(g, version)) {
+                    if (found) {
+                        return lookup_status::found;
+                    }
+                    if (last) {
+                        return lookup_status::missing;
+                    }
+                    break;
+                }
+                b.pause_or_yield();
+            }
+        }
+
+        return lookup_status::missing;
+    }
+
+    group &group_at(size_t hash) const noexcept {
+        return m_map->groups[hash & (NUM_GROUPS - 1)];
+    }
+
+    // Calls f on every group of the probe sequence until it says to stop.
+    // f runs with the group's writer lock held. Returns true for done.
+    template <typename F>
+    bool for_each_group(size_t hash, F &&f) noexcept {
+        for (size_t i = 0; i < NUM_GROUPS; ++i) {
+            group &g = group_at(hash + i);
+            lock(g.writer);
+            const stop s = f(g);
+            unlock(g.writer);
+            if (s != stop::next) {
+                return s == stop::done;
+            }
+        }
+        return false;
+    }
+
+    static bool read_retry(const group &g, uint32_t version) noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return g.version.load(std::memory_order_relaxed) != version;
+    }
+
+    // Only called with the group's writer lock held
+    static void write_begin(group &g) noexcept {
+        g.version.store(g.version.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void write_end(group &g) noexcept {
+        g.version.store(g.version.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    }
+
+    static void store_ctrl(group &g, size_t i, uint8_t value) noexcept {
+        std::atomic_ref<uint8_t>(g.ctrl[i]).store(value,
+                                                  std::memory_order_relaxed);
+    }
+
+    static void lock(std::atomic<uint32_t> &word) noexcept {
+        backoff b;
+        while (word.load(std::memory_order_relaxed) != 0 ||
+               word.exchange(1, std::memory_order_acquire) != 0) {
+            b.pause_or_yield();
+        }
+    }
+
+    static void unlock(std::atomic<uint32_t> &word) noexcept {
+        word.store(0, std::memory_order_release);
+    }
+
+    shared_memory m_shmem;
+    layout *m_map{nullptr};
+};
+
+}  // namespace cpptools
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Snapshot of a shm_memory_resource's heap, summed over every attached
+// process. Approximate while other threads or processes allocate.
+struct shm_memory_stats {
+    size_t capacity{0};   // Bytes in the heap
+    size_t reserved{0};   // Bytes carved from the bump region so far
+    size_t in_use{0};     // Bytes in live blocks, rounded up to size class
+    size_t requested{0};  // Bytes asked for by live allocations
+    size_t cached{0};     // Bytes in freed blocks waiting for reuse
+    size_t padding{0};    // Bytes lost to alignment in the bump region
+    size_t blocks{0};     // Live allocations
+    size_t failed{0};     // Allocations that threw std::bad_alloc
+
+    // Share of the heap handed out to callers
+    [[nodiscard]] double utilization() const noexcept {
+        return capacity ? static_cast<double>(requested) / capacity : 0.0;
+    }
+    // Share of live block bytes lost to size class rounding
+    [[nodiscard]] double internal_fragmentation() const noexcept {
+        return in_use ? 1.0 - static_cast<double>(requested) / in_use : 0.0;
+    }
+    // Share of free bytes that only their own size class can reuse
+    [[nodiscard]] double external_fragmentation() const noexcept {
+        const size_t free = cached + (capacity - reserved);
+        return free ? static_cast<double>(cached) / free : 0.0;
+    }
+};
+
+// std::pmr::memory_resource that allocates from a POSIX shared memory
+// segment. All of its state lives in the segment, so any attached process
+// can allocate, and free blocks allocated by others.
+//
+// Blocks are rounded up to one of a set of size classes, 16 bytes apart up
+// to 128 bytes and four per power of two above that (at most 25% rounding
+// loss). Each class keeps a lock-free free list of freed blocks, linked by
+// offset and tagged against ABA. When its list is empty, a block is carved
+// from a bump region that grows from the start of the heap. Freed blocks
+// stay in their class; the heap never shrinks.
+//
+// Blocks are 16-byte aligned. Larger power-of-two alignments, up to
+// MAX_ALIGNMENT, are served from power-of-two classes, whose blocks are
+// aligned to their size (capped at MAX_ALIGNMENT). As with any
+// memory_resource, deallocate() must get the same size and alignment as
+// allocate().
+//
+// Pointers are only valid in the process that got them; hand blocks to
+// other processes with offset_of() and at().
+class shm_memory_resource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t MIN_ALIGNMENT = 16;
+    static constexpr size_t MAX_ALIGNMENT = 4096;
+    // Offsets are stored in 32 bits of MIN_ALIGNMENT units
+    static constexpr size_t MAX_HEAP_SIZE = (size_t{1} << 32) * MIN_ALIGNMENT;
+
+    // The segment's bookkeeping takes the first few KiB of size. Throws
+    // std::length_error if size leaves no room for a heap or exceeds
+    // MAX_HEAP_SIZE.
+    shm_memory_resource(std::string_view name, size_t size,
+                        const shared_memory_options &options = {});
+    ~shm_memory_resource() override = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shm_memory_resource);
+
+    // Offset of p from the start of the heap, the same in every process
+    [[nodiscard]] size_t offset_of(const void *p) const noexcept {
+        return static_cast<const std::byte *>(p) - m_heap;
+    }
+    [[nodiscard]] void *at(size_t offset) const noexcept {
+        return m_heap + offset;
+    }
+
+    // Bytes actually set aside for an allocation of bytes with alignment
+    [[nodiscard]] static size_t block_size(size_t bytes,
+                                           size_t alignment) noexcept;
+
+    [[nodiscard]] shm_memory_stats stats() const noexcept;
+
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+    [[nodiscard]] std::string name() const { return m_shmem.name(); }
+    [[nodiscard]] int reference_count() const {
+        return m_shmem.reference_count();
+    }
+
+private:
+    static constexpr size_t SMALL_CLASSES = 8;  // 16..128 bytes
+    static constexpr size_t NUM_CLASSES =
+        SMALL_CLASSES + 4 * (std::bit_width(MAX_HEAP_SIZE) - 8);
+
+    // Each class on its own cache line, with its share of the statistics so
+    // that they are updated on a line the allocation touches anyway
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) free_list {
+        // (tag << 32) | (offset / MIN_ALIGNMENT + 1), zero when empty
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> blocks;
+        std::atomic<uint64_t> requested;
+    };
+
+    // Zero-initialized is an empty heap
+    struct header {
+        free_list classes[NUM_CLASSES];
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint64_t> bump;
+        std::atomic<uint64_t> padding;
+        std::atomic<uint64_t> failed;
+    };
+
+    static size_t size_class(size_t bytes) noexcept;
+    static size_t class_size(size_t index) noexcept;
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override;
+
+    void push(free_list &list, size_t offset) noexcept;
+    bool pop(free_list &list, size_t &offset) noexcept;
+    bool carve(size_t size, size_t alignment, size_t &offset) noexcept;
+    std::atomic_ref<uint32_t> next_of(size_t offset) const noexcept;
+
+    shared_memory m_shmem;
+    header *m_header{nullptr};
+    std::byte *m_heap{nullptr};
+    size_t m_capacity{0};
+};
+
+}  // namespace cpptools
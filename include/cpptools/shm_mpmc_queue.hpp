@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "cpptools/backoff.hpp"
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Lock-free bounded multi-producer/multi-consumer queue in POSIX shared
+// memory, after Dmitry Vyukov's bounded MPMC queue. Every cell carries a
+// sequence number that tells producers and consumers whether it is free or
+// filled for the current lap around the ring. The layout holds no pointers,
+// so any number of processes can attach at any address.
+template <typename T, size_t Capacity>
+class shm_mpmc_queue {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Queue elements must be trivially copyable");
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2 greater than 1");
+    static_assert(std::atomic<size_t>::is_always_lock_free);
+
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Sequence numbers are stored relative to the cell index, so that
+    // zero-initialized shared memory is a valid empty queue and no process
+    // has to initialize it. For position pos, the cell is free when its
+    // sequence equals lap(pos) and filled when it equals lap(pos) + 1.
+    struct cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    struct layout {
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> enqueue_pos;
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> dequeue_pos;
+        alignas(CPPTOOLS_CACHELINE_SIZE) cell cells[Capacity];
+    };
+
+    static constexpr size_t lap(size_t pos) noexcept { return pos & ~MASK; }
+
+public:
+    shm_mpmc_queue() = delete;
+    explicit shm_mpmc_queue(std::string_view name)
+        : m_shmem(name, sizeof(layout)),
+          m_queue(m_shmem.as_struct<layout>()) {}
+    ~shm_mpmc_queue() { m_queue = nullptr; }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shm_mpmc_queue);
+
+    bool try_push(const T &item) noexcept {
+        return push(std::span<const T>(&item, 1)) == 1;
+    }
+
+    void push_wait(const T &item) noexcept {
+        backoff b;
+        while (!try_push(item)) {
+            b.pause();
+        }
+    }
+
+    bool try_pop(T &item) noexcept {
+        return pop(std::span<T>(&item, 1)) == 1;
+    }
+
+    void pop_wait(T &item) noexcept {
+        backoff b;
+        while (!try_pop(item)) {
+            b.pause();
+        }
+    }
+
+    // Pushes up to items.size() items, claiming all of their cells with a
+    // single CAS. Returns the number pushed, 0 if the queue is full.
+    size_t push(std::span<const T> items) noexcept {
+        size_t pos{0};
+        const size_t n = claim(m_queue->enqueue_pos, items.size(), 0, pos);
+
+        // Fill and publish each cell
+        for (size_t i = 0; i < n; ++i) {
+            cell &c = cell_at(pos + i);
+            c.data = items[i];
+            c.seq.store(lap(pos + i) + 1, std::memory_order_release);
+        }
+
+        return n;
+    }
+
+    // Pops up to items.size() items, claiming all of their cells with a
+    // single CAS. Returns the number popped, 0 if the queue is empty.
+    size_t pop(std::span<T> items) noexcept {
+        size_t pos{0};
+        const size_t n = claim(m_queue->dequeue_pos, items.size(), 1, pos);
+
+        // Read each cell and hand it back to producers for the next lap
+        for (size_t i = 0; i < n; ++i) {
+            cell &c = cell_at(pos + i);
+            items[i] = c.data;
+            c.seq.store(lap(pos + i) + Capacity, std::memory_order_release);
+        }
+
+        return n;
+    }
+
+    // Blocks until at least one item is pushed/popped
+    size_t push_wait(std::span<const T> items) noexcept {
+        backoff b;
+        size_t n{0};
+        while ((n = push(items)) == 0 && !items.empty()) {
+            b.pause();
+        }
+        return n;
+    }
+
+    size_t pop_wait(std::span<T> items) noexcept {
+        backoff b;
+        size_t n{0};
+        while ((n = pop(items)) == 0 && !items.empty()) {
+            b.pause();
+        }
+        return n;
+    }
+
+    // Approximate while producers/consumers are active
+    [[nodiscard]] size_t size() const noexcept {
+        const size_t deq = m_queue->dequeue_pos.load(std::memory_order_acquire);
+        const size_t enq = m_queue->enqueue_pos.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    auto name() const { return m_shmem.name(); }
+    auto reference_count() const { return m_shmem.reference_count(); }
+
+private:
+    // Claims up to max consecutive cells from cursor whose sequence is
+    // lap(pos) + offset, i.e. free cells for producers (offset 0) or filled
+    // cells for consumers (offset 1). Returns the number claimed and sets
+    // first to the first claimed position.
+    size_t claim(std::atomic<size_t> &cursor, size_t max, size_t offset,
+                 size_t &first) noexcept {
+        size_t pos = cursor.load(std::memory_order_relaxed);
+
+        while (true) {
+            size_t n{0};
+            bool stale{false};
+            for (; n < max && n < Capacity; ++n) {
+                const size_t p = pos + n;
+                const size_t seq =
+                    cell_at(p).seq.load(std::memory_order_acquire);
+                const auto dif = static_cast<intptr_t>(seq) -
+                                 static_cast<intptr_t>(lap(p) + offset);
+                if (dif != 0) {
+                    // dif < 0: full/empty. dif > 0 at the first cell: another
+                    // process already claimed pos, so our cursor is stale.
+                    stale = (n == 0 && dif > 0);
+                    break;
+                }
+            }
+
+            if (stale) {
+                pos = cursor.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (n == 0) {
+                return 0;
+            }
+
+            if (cursor.compare_exchange_weak(pos, pos + n,
+                                             std::memory_order_relaxed)) {
+                first = pos;
+                return n;
+            }
+        }
+    }
+
+    cell &cell_at(size_t pos) noexcept { return m_queue->cells[pos & MASK]; }
+
+    shared_memory m_shmem;
+    layout *m_queue{nullptr};
+};
+
+}  // namespace cpptools
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+namespace cpptools {
+
+// Lock-free single-producer/single-consumer ring buffer in POSIX shared
+// memory. One process (or thread) pushes and one pops; each keeps a local
+// copy of the other side's index and only re-reads the shared one when the
+// cached value says the ring is full/empty.
+template <typename T, size_t Capacity>
+class shm_spsc_queue {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Queue elements must be trivially copyable");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2");
+    static_assert(std::atomic<size_t>::is_always_lock_free);
+
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Shared layout. Indices increase monotonically and are zero in fresh
+    // shared memory, i.e. the ring starts out empty.
+    struct layout {
+        // Next slot to write - only written by the producer
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> head;
+        // Next slot to read - only written by the consumer
+        alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> tail;
+        alignas(CPPTOOLS_CACHELINE_SIZE) T slots[Capacity];
+    };
+
+public:
+    shm_spsc_queue() = delete;
+    explicit shm_spsc_queue(std::string_view name)
+        : m_shmem(name, sizeof(layout)), m_ring(m_shmem.as_struct<layout>()) {
+        m_head = m_ring->head.load(std::memory_order_relaxed);
+        m_tail = m_ring->tail.load(std::memory_order_acquire);
+        m_cached_head = m_head;
+        m_cached_tail = m_tail;
+    }
+    ~shm_spsc_queue() { m_ring = nullptr; }
+
+    CPPTOOLS_NO_COPY_OR_MOVE(shm_spsc_queue);
+
+    // Producer
+
+    bool try_push(const T &item) noexcept {
+        std::span<T> slot = claim_push(1);
+        if (slot.empty()) {
+            return false;
+        }
+
+        slot[0] = item;
+        commit_push(1);
+        return true;
+    }
+
+    // Pushes as many items as fit and publishes them at once. Returns the
+    // number pushed.
+    size_t push(std::span<const T> items) noexcept {
+        size_t pushed{0};
+
+        // At most two contiguous runs: up to the end of the ring, then from
+        // its start
+        for (int run = 0; run < 2 && pushed < items.size(); ++run) {
+            std::span<T> slots = claim(items.size() - pushed, pushed);
+            if (slots.empty()) {
+                break;
+            }
+
+            std::memcpy(slots.data(), items.data() + pushed,
+                        slots.size() * sizeof(T));
+            pushed += slots.size();
+        }
+
+        if (pushed > 0) {
+            commit_push(pushed);
+        }
+        return pushed;
+    }
+
+    // Zero-copy write: returns up to max contiguous free slots to fill in
+    // place, or an empty span if the ring is full. Publish with commit_push().
+    std::span<T> claim_push(size_t max) noexcept { return claim(max, 0); }
+
+    // Publishes the first n slots returned by claim_push()
+    void commit_push(size_t n) noexcept {
+        m_head += n;
+        m_ring->head.store(m_head, std::memory_order_release);
+    }
+
+    // Consumer
+
+    bool try_pop(T &item) noexcept {
+        std::span<const T> slot = claim_pop(1);
+        if (slot.empty()) {
+            return false;
+        }
+
+        item = slot[0];
+        commit_pop(1);
+        return true;
+    }
+
+    // Pops as many items as are available, up to items.size(), and releases
+    // their slots at once. Returns the number popped.
+    size_t pop(std::span<T> items) noexcept {
+        size_t popped{0};
+
+        for (int run = 0; run < 2 && popped < items.size(); ++run) {
+            std::span<const T> slots = peek(items.size() - popped, popped);
+            if (slots.empty()) {
+                break;
+            }
+
+            std::memcpy(items.data() + popped, slots.data(),
+                        slots.size() * sizeof(T));
+            popped += slots.size();
+        }
+
+        if (popped > 0) {
+            commit_pop(popped);
+        }
+        return popped;
+    }
+
+    // Zero-copy read: returns up to max contiguous filled slots to read in
+    // place, or an empty span if the ring is empty. Release with
+    // commit_pop().
+    std::span<const T> claim_pop(size_t max) noexcept { return peek(max, 0); }
+
+    // Releases the first n slots returned by claim_pop()
+    void commit_pop(size_t n) noexcept {
+        m_tail += n;
+        m_ring->tail.store(m_tail, std::memory_order_release);
+    }
+
+    // Either side
+
+    [[nodiscard]] size_t size() const noexcept {
+        const size_t tail = m_ring->tail.load(std::memory_order_acquire);
+        const size_t head = m_ring->head.load(std::memory_order_acquire);
+        return head - tail;
+    }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    auto name() const { return m_shmem.name(); }
+    auto reference_count() const { return m_shmem.reference_count(); }
+
+private:
+    // Free contiguous slots starting offset slots past the producer's head
+    std::span<T> claim(size_t max, size_t offset) noexcept {
+        const size_t head = m_head + offset;
+        if (Capacity - (head - m_cached_tail) < std::min(max, Capacity)) {
+            // Looks full - refresh our copy of the consumer's index
+            m_cached_tail = m_ring->tail.load(std::memory_order_acquire);
+        }
+
+        const size_t idx = head & MASK;
+        const size_t n = std::min(
+            {max, Capacity - (head - m_cached_tail), Capacity - idx});
+        return std::span<T>(m_ring->slots + idx, n);
+    }
+
+    // Filled contiguous slots starting offset slots past the consumer's tail
+    std::span<const T> peek(size_t max, size_t offset) noexcept {
+        const size_t tail = m_tail + offset;
+        if (m_cached_head - tail < std::min(max, Capacity)) {
+            // Looks empty - refresh our copy of the producer's index
+            m_cached_head = m_ring->head.load(std::memory_order_acquire);
+        }
+
+        const size_t idx = tail & MASK;
+        const size_t n = std::min({max, m_cached_head - tail, Capacity - idx});
+        return std::span<const T>(m_ring->slots + idx, n);
+    }
+
+    shared_memory m_shmem;
+    layout *m_ring{nullptr};
+
+    // Producer-local state
+    size_t m_head{0};
+    size_t m_cached_tail{0};
+
+    // Consumer-local state
+    size_t m_tail{0};
+    size_t m_cached_head{0};
+};
+
+}  // namespace cpptools
@@ -2,16 +2,19 @@
 
 #include <atomic>
 
+#include "cpptools/backoff.hpp"
 #include "cpptools/macros.hpp"
 
 namespace cpptools {
 
-// Fast spinlock mutex
+// Fast test-and-test-and-set spinlock mutex with exponential backoff
 class spinlock_mutex {
     std::atomic_flag flag_{ATOMIC_FLAG_INIT};
+    backoff_limits limits_;
 
 public:
     spinlock_mutex() = default;
+    explicit spinlock_mutex(backoff_limits limits) noexcept : limits_(limits) {}
     ~spinlock_mutex() = default;
 
     CPPTOOLS_NO_COPY_OR_MOVE(spinlock_mutex);
@@ -19,6 +22,8 @@ public:
     void lock();
     bool try_lock() noexcept;
     void unlock() noexcept;
+
+    backoff_limits limits() const noexcept { return limits_; }
 };
 
 }  // namespace cpptools
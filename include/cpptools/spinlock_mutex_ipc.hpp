@@ -1,33 +1,60 @@
 #pragma once
 
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
 #include <string_view>
 
 #include "cpptools/macros.hpp"
 #include "cpptools/shared_memory.hpp"
-#include "cpptools/spinlock_mutex.hpp"
 
 namespace cpptools {
 
-// Fast spinlock mutex for IPC via POSIX shared memory
+// Result of spinlock_mutex_ipc::lock()
+enum class lock_status : uint8_t {
+    acquired,    // Normal acquisition
+    owner_dead,  // Recovered from a dead owner, protected state may be
+                 // inconsistent (like EOWNERDEAD)
+};
+
+// Fast spinlock mutex for IPC via POSIX shared memory. The lock word holds
+// the owner's thread id, so a waiter that has spun for a while checks
+// whether the owner still exists and takes the lock over if it doesn't.
+//
+// Owner ids are kernel thread ids, so all processes must share a pid
+// namespace. A thread id reused by an unrelated process before a waiter
+// checks is mistaken for a live owner.
 class spinlock_mutex_ipc {
 public:
+    // Polls between owner liveness checks
+    static constexpr uint32_t POLLS_BEFORE_CHECK = 1 << 12;
+
     spinlock_mutex_ipc() = delete;
-    spinlock_mutex_ipc(std::string_view name)
-        : m_shmem(name, sizeof(spinlock_mutex)),
-          m_mutex(m_shmem.as_struct<spinlock_mutex>()) {}
-    ~spinlock_mutex_ipc() { m_mutex = nullptr; }
+    explicit spinlock_mutex_ipc(std::string_view name);
+    ~spinlock_mutex_ipc() { m_owner = nullptr; }
 
     CPPTOOLS_NO_COPY_OR_MOVE(spinlock_mutex_ipc);
 
-    auto lock() { return m_mutex->lock(); }
-    auto try_lock() noexcept { return m_mutex->try_lock(); }
-    auto unlock() noexcept { return m_mutex->unlock(); }
+    lock_status lock() noexcept;
+    // A single CAS: fails on a lock held by a dead owner, which only lock()
+    // recovers
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+
+    // Thread id of the current owner, 0 if unlocked
+    pid_t owner() const noexcept {
+        return static_cast<pid_t>(m_owner->load(std::memory_order_relaxed));
+    }
+
     auto name() const { return m_shmem.name(); }
     auto reference_count() const { return m_shmem.reference_count(); }
 
 private:
+    lock_status lock_slow(uint32_t self) noexcept;
+
     shared_memory m_shmem;
-    spinlock_mutex* m_mutex{nullptr};
+    std::atomic<uint32_t> *m_owner{nullptr};
 };
 
 }  // namespace cpptools
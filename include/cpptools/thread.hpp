@@ -1,38 +1,151 @@
 #pragma once
 
+#include <pthread.h>
+
 #include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "cpptools/latency_profile.hpp"
 #include "cpptools/macros.hpp"
 
 namespace cpptools {
 
-// Nameable, pinnable thread
-class thread : public std::thread {
-    static constexpr size_t MAX_NAME_LEN = 15;
+// Settings applied when a thread is created, before its function runs
+struct thread_attributes {
+    // CPUs the thread may run on; empty inherits the creator's affinity
+    std::vector<int> cpus;
+    // Thread name, at most 15 characters; empty inherits the creator's
+    std::string name;
+    // Stack size in bytes; 0 uses the default
+    size_t stack_size{0};
+    // Guard region below the stack in bytes; unset uses the default
+    std::optional<size_t> guard_size;
+    // NUMA node to place the stack on; -1 picks the node of cpus if they
+    // all share one
+    int stack_node{-1};
+    // Latency settings applied on the new thread, see latency_profile
+    std::optional<latency_profile> latency;
+};
 
+// Nameable, pinnable thread. Owns a pthread created with the requested
+// attributes, so affinity, name and stack are in place before the thread
+// function runs.
+class thread {
 public:
+    static constexpr size_t MAX_NAME_LEN = 15;
+
     thread() noexcept = default;
-    ~thread() = default;
+    // Like std::thread, destroying a joinable thread terminates
+    ~thread();
 
     thread(thread&& other) noexcept;
+    thread& operator=(thread&& other) noexcept;
+
+    template <class F, class... Args>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, latency_profile> &&
+                 !std::is_same_v<std::remove_cvref_t<F>, thread_attributes>)
+    explicit thread(F&& f, Args&&... args) {
+        start({},
+              make_routine(std::forward<F>(f), std::forward<Args>(args)...));
+    }
+
+    // Throws std::length_error for a name that's too long, std::system_error
+    // if the thread can't be created, and std::runtime_error if a strict
+    // latency profile fails (in which case f doesn't run).
+    template <class F, class... Args>
+    thread(const thread_attributes& attributes, F&& f, Args&&... args) {
+        start(attributes,
+              make_routine(std::forward<F>(f), std::forward<Args>(args)...));
+    }
 
+    // Applies profile on the new thread before f runs, see latency()
     template <class F, class... Args>
-    explicit thread(F&& f, Args&&... args) : std::thread(f, args...) {}
+    thread(const latency_profile& profile, F&& f, Args&&... args) {
+        thread_attributes attributes;
+        attributes.latency = profile;
+        start(attributes,
+              make_routine(std::forward<F>(f), std::forward<Args>(args)...));
+    }
 
     CPPTOOLS_NO_COPY(thread);
 
+    bool joinable() const noexcept { return joinable_; }
+    void join();
+    void detach();
+    void swap(thread& other) noexcept;
+    pthread_t native_handle() const noexcept { return handle_; }
+
+    // Like std::thread::get_id(): the owned thread's ID, as seen from it by
+    // std::this_thread::get_id(), or a default ID if not joinable
+    std::thread::id get_id() const noexcept;
+
+    static unsigned int hardware_concurrency() noexcept {
+        return std::thread::hardware_concurrency();
+    }
+
+    // Act on the owned thread if joinable, else on the calling thread
     bool set_name(const std::string_view&) noexcept;
     std::string_view name() const { return name_; }
 
     bool set_core(int core) noexcept;
     int core() const { return core_; }
 
+    // NUMA node the stack was bound to, -1 if none
+    int stack_node() const { return stack_node_; }
+
+    // What the latency profile put in place, empty without one
+    const latency_report& latency() const { return latency_; }
+
 private:
+    struct routine {
+        virtual ~routine() = default;
+        virtual void run() = 0;
+    };
+
+    template <class F, class... Args>
+    struct routine_impl : routine {
+        template <class... Ts>
+        explicit routine_impl(Ts&&... ts) : call(std::forward<Ts>(ts)...) {}
+
+        void run() override {
+            std::apply(
+                [](auto& f, auto&... args) {
+                    std::invoke(std::move(f), std::move(args)...);
+                },
+                call);
+        }
+
+        std::tuple<F, Args...> call;
+    };
+
+    template <class F, class... Args>
+    static std::unique_ptr<routine> make_routine(F&& f, Args&&... args) {
+        return std::make_unique<
+            routine_impl<std::decay_t<F>, std::decay_t<Args>...>>(
+            std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    struct launch;
+    static void* trampoline(void* arg);
+
+    void start(const thread_attributes& attributes,
+               std::unique_ptr<routine> fn);
+
+    pthread_t handle_{};
+    bool joinable_{false};
     std::string name_;
     int core_{-1};
+    int stack_node_{-1};
+    latency_report latency_;
 };
 
 }  // namespace cpptools
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cpptools/adaptive_mutex.hpp"
+#include "cpptools/chase_lev_deque.hpp"
+#include "cpptools/macros.hpp"
+#include "cpptools/thread.hpp"
+
+namespace cpptools {
+
+struct thread_pool_options {
+    static constexpr uint32_t DEFAULT_SPINS_BEFORE_PARK = 1 << 10;
+
+    // Number of workers. Zero selects one per entry in cores, or one per
+    // hardware thread if cores is empty.
+    size_t threads{0};
+    // Worker i is pinned to cores[i % cores.size()]; empty leaves workers
+    // unpinned
+    std::vector<int> cores;
+    // Workers are named "<name>-<i>", truncated to the thread name limit
+    std::string name{"pool"};
+    // Failed attempts to find work before an idle worker parks
+    uint32_t spins_before_park{DEFAULT_SPINS_BEFORE_PARK};
+};
+
+// Work-stealing thread pool. Each worker is a named, optionally pinned
+// cpptools::thread with its own Chase-Lev deque: tasks submitted by a
+// worker go to its own deque, tasks submitted from outside go to a shared
+// injection queue. Idle workers steal from random victims, spin for a while
+// and then park until new work arrives.
+//
+// Tasks must not throw.
+class thread_pool {
+public:
+    // Throws std::system_error if a worker can't be created, e.g. for a
+    // core that doesn't exist
+    explicit thread_pool(const thread_pool_options &options = {});
+    // Runs all submitted tasks, then joins the workers
+    ~thread_pool();
+
+    CPPTOOLS_NO_COPY_OR_MOVE(thread_pool);
+
+    template <typename F>
+    void submit(F &&f) {
+        push(new task(std::forward<F>(f)));
+    }
+
+    // Submits every callable in [first, last), waking workers once
+    template <typename It>
+    void submit(It first, It last) {
+        std::vector<task *> tasks;
+        tasks.reserve(std::distance(first, last));
+        for (; first != last; ++first) {
+            tasks.push_back(new task(*first));
+        }
+        push(tasks);
+    }
+
+    // Calls f(i) for every i in [begin, end) and returns when all calls are
+    // done. Ranges are split lazily: a chunk of grain indices at a time is
+    // run, and the rest is split in half only while the local queue has
+    // nothing for thieves to take. Zero grain picks one from the range and
+    // pool size. The calling thread takes part.
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, F &&f, size_t grain = 0) {
+        if (begin >= end) {
+            return;
+        }
+        if (grain == 0) {
+            grain = std::max<size_t>(1, (end - begin) / (16 * size()));
+        }
+
+        range_job job{[&f](size_t b, size_t e) {
+                          for (size_t i = b; i < e; ++i) {
+                              f(i);
+                          }
+                      },
+                      grain};
+        run_range(job, begin, end);
+        wait(job.pending);
+    }
+
+    // Returns once every task submitted so far has run. The calling thread
+    // helps run them.
+    void wait() { wait(m_pending); }
+
+    size_t size() const noexcept { return m_workers.size(); }
+
+private:
+    using task = std::function<void()>;
+
+    struct range_job {
+        std::function<void(size_t, size_t)> body;
+        size_t grain;
+        std::atomic<size_t> pending{0};
+    };
+
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) worker {
+        chase_lev_deque<task *> deque;
+        cpptools::thread thread;
+        uint64_t rng{0};
+    };
+
+    void run_worker(size_t index);
+    void stop_workers();
+    void push(task *t);
+    void push(const std::vector<task *> &tasks);
+    void wake(size_t count) noexcept;
+    void park();
+    void run(task *t) noexcept;
+
+    // Next task for the calling thread: its own deque if it's one of our
+    // workers, then the injection queue, then a random victim
+    task *find_task() noexcept;
+    task *pop_injected() noexcept;
+    task *steal(uint64_t &rng, size_t self) noexcept;
+    bool has_work() const noexcept;
+
+    void run_range(range_job &job, size_t begin, size_t end);
+    size_t local_backlog() const noexcept;
+    void wait(const std::atomic<size_t> &pending);
+
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    // Tasks submitted from outside the pool
+    adaptive_mutex m_injection_lock;
+    std::deque<task *> m_injection;
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> m_injected{0};
+
+    // Submitted tasks that haven't finished running
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<size_t> m_pending{0};
+
+    // Parking: workers wait for m_signal to change, submitters bump it only
+    // when someone is parked
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> m_signal{0};
+    std::atomic<uint32_t> m_parked{0};
+    std::atomic<bool> m_stopping{false};
+
+    const uint32_t m_spins_before_park;
+};
+
+}  // namespace cpptools
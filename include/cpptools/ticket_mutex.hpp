@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "cpptools/macros.hpp"
+
+namespace cpptools {
+
+// FIFO-fair ticket spinlock mutex. Valid when zero-initialized, so it can be
+// placed in shared memory (see ticket_mutex_ipc).
+class ticket_mutex {
+    // Ticket dispenser and now-serving counter live on separate cache lines
+    // so that arriving threads don't invalidate the line waiters spin on
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> next_{0};
+    alignas(CPPTOOLS_CACHELINE_SIZE) std::atomic<uint32_t> serving_{0};
+
+public:
+    ticket_mutex() = default;
+    ~ticket_mutex() = default;
+
+    CPPTOOLS_NO_COPY_OR_MOVE(ticket_mutex);
+
+    void lock() noexcept;
+    bool try_lock() noexcept;
+    void unlock() noexcept;
+};
+
+}  // namespace cpptools
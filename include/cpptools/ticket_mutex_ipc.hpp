@@ -0,0 +1,11 @@
+#pragma once
+
+#include "cpptools/mutex_ipc.hpp"
+#include "cpptools/ticket_mutex.hpp"
+
+namespace cpptools {
+
+// FIFO-fair ticket mutex for IPC via POSIX shared memory
+using ticket_mutex_ipc = mutex_ipc<ticket_mutex>;
+
+}  // namespace cpptools
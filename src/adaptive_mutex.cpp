@@ -0,0 +1,86 @@
+#include "cpptools/adaptive_mutex.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "futex word must be a plain 32-bit integer");
+
+// Shared (not FUTEX_PRIVATE_FLAG) futex ops, so waiters in other processes
+// mapping the same memory are woken too
+void futex_wait(std::atomic<uint32_t> &word, uint32_t expected) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT,
+            expected, nullptr, nullptr, 0);
+}
+
+void futex_wake_one(std::atomic<uint32_t> &word) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1,
+            nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+void adaptive_mutex::lock() noexcept {
+    // Fast path: a single CAS when the mutex is uncontended.
+    uint32_t expected = UNLOCKED;
+    if (state_.compare_exchange_strong(expected, LOCKED,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+    }
+    lock_slow();
+}
+
+void adaptive_mutex::lock_slow() noexcept {
+    // Spin phase: poll with plain loads while the holder is running and
+    // nobody is parked yet. Once someone is parked, spinning only delays us
+    // joining the queue.
+    const uint32_t budget = spin_budget();
+    for (uint32_t i = 0; i < budget; ++i) {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if (state == CONTENDED) {
+            break;
+        }
+        if (state == UNLOCKED &&
+            state_.compare_exchange_weak(state, LOCKED,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+        cpu_relax();
+    }
+
+    // Park phase: mark the mutex contended so the holder wakes someone on
+    // unlock. Having done so we must keep it marked contended when we
+    // acquire, since other waiters may still be parked.
+    while (state_.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED) {
+        futex_wait(state_, CONTENDED);
+    }
+}
+
+bool adaptive_mutex::try_lock() noexcept {
+    uint32_t expected = UNLOCKED;
+    return state_.compare_exchange_strong(expected, LOCKED,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+}
+
+void adaptive_mutex::unlock() noexcept {
+    // Only enter the kernel if a waiter may be parked.
+    if (state_.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) {
+        futex_wake_one(state_);
+    }
+}
+
+}  // namespace cpptools
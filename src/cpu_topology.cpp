@@ -0,0 +1,321 @@
+#include "cpptools/cpu_topology.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "cpptools/numa.hpp"
+
+namespace cpptools {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool contains(const std::vector<int> &ids, int id) noexcept {
+    return std::binary_search(ids.begin(), ids.end(), id);
+}
+
+int to_int(std::string_view str, int fallback) noexcept {
+    int value{0};
+    if (std::from_chars(str.data(), str.data() + str.size(), value).ec !=
+        std::errc{}) {
+        return fallback;
+    }
+    return value;
+}
+
+// Value of key=... on the kernel command line. isolcpus may carry flags
+// before the list ("isolcpus=nohz,domain,2-5"), which are dropped.
+std::string cmdline_list(const std::string &cmdline, std::string_view key) {
+    std::istringstream in(cmdline);
+    std::string arg;
+    while (in >> arg) {
+        if (!arg.starts_with(key) || arg.size() <= key.size() ||
+            arg[key.size()] != '=') {
+            continue;
+        }
+        std::string value = arg.substr(key.size() + 1);
+        const size_t first_digit = value.find_first_of("0123456789");
+        return first_digit == std::string::npos ? ""
+                                                : value.substr(first_digit);
+    }
+    return "";
+}
+
+}  // namespace
+
+cpu_topology::cpu_topology() : cpu_topology("") {}
+
+cpu_topology::cpu_topology(std::string_view root) : m_root(root) {
+    read_cpus();
+    read_cpu_sets();
+}
+
+std::string cpu_topology::read_line(const std::string &path) const {
+    std::ifstream file(m_root + path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::vector<int> cpu_topology::read_list(const std::string &path) const {
+    return numa::parse_list(read_line(path));
+}
+
+void cpu_topology::read_cpus() {
+    const std::string cpu_dir = "/sys/devices/system/cpu";
+
+    std::error_code ec;
+    if (!fs::is_directory(m_root + cpu_dir, ec)) {
+        throw std::runtime_error(
+            std::format("CPU topology not found at \"{}{}\"", m_root, cpu_dir));
+    }
+
+    std::vector<int> online = read_list(cpu_dir + "/online");
+    if (online.empty()) {
+        // No online list: take every cpuN directory
+        for (const auto &entry :
+             fs::directory_iterator(m_root + cpu_dir, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.starts_with("cpu") && name.size() > 3) {
+                const int id = to_int(std::string_view(name).substr(3), -1);
+                if (id >= 0) {
+                    online.push_back(id);
+                }
+            }
+        }
+        std::sort(online.begin(), online.end());
+    }
+
+    for (const int id : online) {
+        const std::string dir = std::format("{}/cpu{}", cpu_dir, id);
+        if (!fs::is_directory(m_root + dir, ec)) {
+            continue;
+        }
+
+        cpu_info info;
+        info.id = id;
+        info.socket =
+            to_int(read_line(dir + "/topology/physical_package_id"), 0);
+        info.core = to_int(read_line(dir + "/topology/core_id"), id);
+        info.smt_siblings = read_list(dir + "/topology/thread_siblings_list");
+        if (info.smt_siblings.empty()) {
+            info.smt_siblings = {id};
+        }
+
+        // The CPU's directory links to its node as "nodeN"
+        for (const auto &entry : fs::directory_iterator(m_root + dir, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.starts_with("node")) {
+                info.node = to_int(std::string_view(name).substr(4), 0);
+                break;
+            }
+        }
+
+        // Shared caches, named by their lowest CPU. Instruction caches are
+        // skipped.
+        for (int index = 0;; ++index) {
+            const std::string cache =
+                std::format("{}/cache/index{}", dir, index);
+            if (!fs::is_directory(m_root + cache, ec)) {
+                break;
+            }
+            if (read_line(cache + "/type") == "Instruction") {
+                continue;
+            }
+            const std::vector<int> shared =
+                read_list(cache + "/shared_cpu_list");
+            const int domain = shared.empty() ? id : shared.front();
+            switch (to_int(read_line(cache + "/level"), 0)) {
+                case 2:
+                    info.l2_domain = domain;
+                    break;
+                case 3:
+                    info.l3_domain = domain;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        m_cpus.push_back(std::move(info));
+    }
+}
+
+void cpu_topology::read_cpu_sets() {
+    const std::string cmdline = read_line("/proc/cmdline");
+
+    m_isolated = read_list("/sys/devices/system/cpu/isolated");
+    if (m_isolated.empty()) {
+        m_isolated = numa::parse_list(cmdline_list(cmdline, "isolcpus"));
+    }
+    m_nohz_full = read_list("/sys/devices/system/cpu/nohz_full");
+    if (m_nohz_full.empty()) {
+        m_nohz_full = numa::parse_list(cmdline_list(cmdline, "nohz_full"));
+    }
+
+    // Cpus_allowed_list of our own process
+    std::ifstream status(m_root + "/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        constexpr std::string_view key = "Cpus_allowed_list:";
+        if (line.starts_with(key)) {
+            m_allowed = numa::parse_list(line.substr(key.size()));
+            break;
+        }
+    }
+    if (m_allowed.empty()) {
+        for (const cpu_info &info : m_cpus) {
+            m_allowed.push_back(info.id);
+        }
+    }
+
+    for (auto *set : {&m_isolated, &m_nohz_full, &m_allowed}) {
+        std::sort(set->begin(), set->end());
+        set->erase(std::unique(set->begin(), set->end()), set->end());
+    }
+}
+
+const cpu_info *cpu_topology::cpu(int id) const noexcept {
+    const auto it = std::lower_bound(
+        m_cpus.begin(), m_cpus.end(), id,
+        [](const cpu_info &info, int value) { return info.id < value; });
+    return (it != m_cpus.end() && it->id == id) ? &*it : nullptr;
+}
+
+std::vector<int> cpu_topology::sockets() const {
+    std::set<int> ids;
+    for (const cpu_info &info : m_cpus) {
+        ids.insert(info.socket);
+    }
+    return {ids.begin(), ids.end()};
+}
+
+std::vector<int> cpu_topology::nodes() const {
+    std::set<int> ids;
+    for (const cpu_info &info : m_cpus) {
+        ids.insert(info.node);
+    }
+    return {ids.begin(), ids.end()};
+}
+
+std::vector<int> cpu_topology::cpus_on_socket(int socket) const {
+    std::vector<int> ids;
+    for (const cpu_info &info : m_cpus) {
+        if (info.socket == socket) {
+            ids.push_back(info.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> cpu_topology::cpus_on_node(int node) const {
+    std::vector<int> ids;
+    for (const cpu_info &info : m_cpus) {
+        if (info.node == node) {
+            ids.push_back(info.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> cpu_topology::physical_cores() const {
+    std::vector<int> ids;
+    std::set<std::pair<int, int>> seen;
+    for (const cpu_info &info : m_cpus) {
+        if (seen.emplace(info.socket, info.core).second) {
+            ids.push_back(info.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> cpu_topology::sharing_cache(int cpu_id, int level) const {
+    const cpu_info *self = cpu(cpu_id);
+    if (self == nullptr) {
+        return {};
+    }
+
+    const int domain = (level == 2) ? self->l2_domain : self->l3_domain;
+    if (domain < 0) {
+        return {cpu_id};
+    }
+
+    std::vector<int> ids;
+    for (const cpu_info &info : m_cpus) {
+        if (((level == 2) ? info.l2_domain : info.l3_domain) == domain) {
+            ids.push_back(info.id);
+        }
+    }
+    return ids;
+}
+
+bool cpu_topology::is_isolated(int cpu_id) const noexcept {
+    return contains(m_isolated, cpu_id) || contains(m_nohz_full, cpu_id);
+}
+
+bool cpu_topology::is_allowed(int cpu_id) const noexcept {
+    return contains(m_allowed, cpu_id);
+}
+
+std::vector<int> cpu_topology::place(const placement_request &request) const {
+    if (request.count == 0) {
+        return {};
+    }
+
+    const cpu_info *anchor = nullptr;
+    if (request.share_l3_with >= 0) {
+        anchor = cpu(request.share_l3_with);
+        if (anchor == nullptr) {
+            return {};
+        }
+    }
+
+    // Candidates per socket, keeping one thread per core if asked to
+    std::map<int, std::vector<int>> by_socket;
+    std::set<std::pair<int, int>> used_cores;
+    for (const cpu_info &info : m_cpus) {
+        if (request.socket >= 0 && info.socket != request.socket) {
+            continue;
+        }
+        if (anchor != nullptr && (anchor->l3_domain < 0
+                                      ? info.socket != anchor->socket
+                                      : info.l3_domain != anchor->l3_domain)) {
+            continue;
+        }
+        if (request.isolated_only && !is_isolated(info.id)) {
+            continue;
+        }
+        if (request.allowed_only && !is_allowed(info.id)) {
+            continue;
+        }
+        if (request.no_smt_siblings &&
+            !used_cores.emplace(info.socket, info.core).second) {
+            continue;
+        }
+        by_socket[info.socket].push_back(info.id);
+    }
+
+    // First socket that fits everything
+    for (const auto &[socket, ids] : by_socket) {
+        if (ids.size() >= request.count) {
+            return {ids.begin(), ids.begin() + request.count};
+        }
+    }
+    return {};
+}
+
+}  // namespace cpptools
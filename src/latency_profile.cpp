@@ -0,0 +1,142 @@
+#include "cpptools/latency_profile.hpp"
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <string>
+
+#include "cpptools/cpu_topology.hpp"
+
+namespace cpptools {
+
+namespace {
+
+// Room left for frames above the prefaulted region and for signal handlers
+constexpr size_t STACK_RESERVE = 16 * 1024;
+
+// Usable stack below the caller's frame, or 0 if unknown
+size_t stack_room() noexcept {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return 0;
+    }
+
+    void *addr{nullptr};
+    size_t size{0};
+    const int ret = pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return 0;
+    }
+
+    // The stack grows down from addr + size
+    const char here{0};
+    const size_t used = static_cast<size_t>(static_cast<char *>(addr) + size -
+                                            &here);
+    return used + STACK_RESERVE < size ? size - used - STACK_RESERVE : 0;
+}
+
+// Touches bytes of stack below this frame. Not inlined so the alloca() is
+// popped on return.
+[[gnu::noinline]] void touch_stack(size_t bytes) noexcept {
+    auto *stack = static_cast<volatile char *>(alloca(bytes));
+    const size_t page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += page) {
+        stack[i] = 0;
+    }
+}
+
+std::string step_error(const char *step, int err) {
+    return std::format("{}: {}", step, strerror(err));
+}
+
+}  // namespace
+
+latency_report apply_latency_profile(const latency_profile &profile) {
+    latency_report report;
+
+    // Lock memory first, so that the stack touched below stays resident
+    if (profile.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            report.memory_locked = true;
+        } else {
+            report.errors.push_back(step_error("mlockall", errno));
+        }
+    }
+
+    if (profile.set_scheduling) {
+        sched_param param{};
+        param.sched_priority = profile.priority;
+        const int err =
+            pthread_setschedparam(pthread_self(), profile.policy, &param);
+        if (err != 0) {
+            report.errors.push_back(std::format(
+                "sched policy {} priority {}: {}", profile.policy,
+                profile.priority, strerror(err)));
+        }
+    }
+
+    if (profile.stack_prefault > 0) {
+        const size_t bytes = std::min(profile.stack_prefault, stack_room());
+        touch_stack(bytes);
+        report.stack_prefaulted = bytes;
+        if (bytes < profile.stack_prefault) {
+            report.errors.push_back(std::format(
+                "stack prefault: {} of {} bytes fit in the stack", bytes,
+                profile.stack_prefault));
+        }
+    }
+
+    if (profile.timer_slack_ns >= 0) {
+        if (prctl(PR_SET_TIMERSLACK, profile.timer_slack_ns, 0, 0, 0) != 0) {
+            report.errors.push_back(step_error("timer slack", errno));
+        }
+    }
+
+    if (profile.require_isolated) {
+        try {
+            const cpu_topology topology;
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            sched_getaffinity(0, sizeof(cpus), &cpus);
+
+            report.isolated = true;
+            std::string not_isolated;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &cpus) && !topology.is_isolated(cpu)) {
+                    report.isolated = false;
+                    not_isolated += std::format(
+                        "{}{}", not_isolated.empty() ? "" : ",", cpu);
+                }
+            }
+            if (!report.isolated) {
+                report.errors.push_back(
+                    std::format("CPUs {} are not isolated", not_isolated));
+            }
+        } catch (const std::exception &e) {
+            report.errors.push_back(
+                std::format("isolation check: {}", e.what()));
+        }
+    }
+
+    // Read back what's in effect
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &report.policy, &param) == 0) {
+        report.priority = param.sched_priority;
+    }
+    report.timer_slack_ns = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+
+    return report;
+}
+
+}  // namespace cpptools
@@ -0,0 +1,113 @@
+#include "cpptools/mcs_mutex.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+// Per-thread pool of queue nodes. A thread needs one node per MCS mutex it
+// holds or waits on at the same time, so the pool rarely grows past a few.
+thread_local std::vector<std::unique_ptr<mcs_mutex::node>> t_node_pool;
+
+mcs_mutex::node *acquire_node() {
+    if (t_node_pool.empty()) {
+        return new mcs_mutex::node;
+    }
+
+    mcs_mutex::node *n = t_node_pool.back().release();
+    t_node_pool.pop_back();
+    return n;
+}
+
+void release_node(mcs_mutex::node *n) { t_node_pool.emplace_back(n); }
+
+// Spins before yielding the CPU. A queue lock hands over to one specific
+// waiter, so if that waiter is preempted everyone behind it waits a full
+// scheduler quantum unless the spinners get out of its way.
+constexpr uint32_t SPINS_BEFORE_YIELD = 1 << 10;
+
+void spin_wait(uint32_t &spins) {
+    if (++spins < SPINS_BEFORE_YIELD) {
+        cpu_relax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+}  // namespace
+
+void mcs_mutex::lock() noexcept {
+    node *self = acquire_node();
+    self->next.store(nullptr, std::memory_order_relaxed);
+    self->locked.store(true, std::memory_order_relaxed);
+
+    // Join the queue
+    node *prev = tail_.exchange(self, std::memory_order_acq_rel);
+    if (prev != nullptr) {
+        // Link behind our predecessor and spin on our own node until it
+        // hands the lock over.
+        prev->next.store(self, std::memory_order_release);
+        uint32_t spins{0};
+        while (self->locked.load(std::memory_order_acquire)) {
+            spin_wait(spins);
+        }
+    }
+
+    holder_ = self;
+}
+
+bool mcs_mutex::try_lock() noexcept {
+    node *self = acquire_node();
+    self->next.store(nullptr, std::memory_order_relaxed);
+
+    // Only succeed if the queue is empty
+    node *expected = nullptr;
+    if (tail_.compare_exchange_strong(expected, self,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        holder_ = self;
+        return true;
+    }
+
+    release_node(self);
+    return false;
+}
+
+void mcs_mutex::unlock() noexcept {
+    node *self = holder_;
+    holder_ = nullptr;
+
+    node *next = self->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+        // No known successor: try to mark the queue empty
+        node *expected = self;
+        if (tail_.compare_exchange_strong(expected, nullptr,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+            release_node(self);
+            return;
+        }
+
+        // A successor swapped itself into the tail but hasn't linked behind
+        // us yet - wait for it.
+        uint32_t spins{0};
+        while ((next = self->next.load(std::memory_order_acquire)) ==
+               nullptr) {
+            spin_wait(spins);
+        }
+    }
+
+    // Hand over. The successor no longer touches our node after linking, so
+    // it can go back into the pool.
+    next->locked.store(false, std::memory_order_release);
+    release_node(self);
+}
+
+}  // namespace cpptools
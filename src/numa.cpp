@@ -0,0 +1,190 @@
+#include "cpptools/numa.hpp"
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace cpptools::numa {
+
+namespace {
+
+// Highest node number mbind() accepts in our node mask
+constexpr int MAX_NODES = 1024;
+constexpr size_t BITS_PER_WORD = sizeof(unsigned long) * CHAR_BIT;
+
+// move_pages() batch size
+constexpr size_t PAGES_PER_QUERY = 4096;
+
+}  // namespace
+
+std::vector<int> parse_list(std::string_view list) {
+    std::vector<int> ids;
+
+    while (!list.empty()) {
+        const size_t comma = list.find(',');
+        std::string_view range = list.substr(0, comma);
+        list = (comma == std::string_view::npos) ? std::string_view{}
+                                                 : list.substr(comma + 1);
+
+        // Trim whitespace and newlines
+        constexpr std::string_view whitespace = " \t\n";
+        const size_t start = range.find_first_not_of(whitespace);
+        if (start == std::string_view::npos) {
+            continue;
+        }
+        range = range.substr(start,
+                             range.find_last_not_of(whitespace) - start + 1);
+
+        int first{0};
+        int last{0};
+        const size_t dash = range.find('-');
+        const auto *begin = range.data();
+        const auto *end = range.data() + range.size();
+        if (dash == std::string_view::npos) {
+            if (std::from_chars(begin, end, first).ec != std::errc{}) {
+                continue;
+            }
+            last = first;
+        } else if (std::from_chars(begin, begin + dash, first).ec !=
+                       std::errc{} ||
+                   std::from_chars(begin + dash + 1, end, last).ec !=
+                       std::errc{}) {
+            continue;
+        }
+
+        for (int id = first; id <= last; ++id) {
+            ids.push_back(id);
+        }
+    }
+
+    return ids;
+}
+
+std::vector<int> online_nodes() {
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    if (!std::getline(file, list)) {
+        // No NUMA support: everything is on node 0
+        return {0};
+    }
+    return parse_list(list);
+}
+
+int node_of_cpu(int cpu) noexcept {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    const fs::path dir(std::format("/sys/devices/system/cpu/cpu{}", cpu));
+    if (!fs::is_directory(dir, ec)) {
+        return -1;
+    }
+
+    // The CPU's directory links to its node as "nodeN"
+    for (const auto &entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        int node{0};
+        if (name.starts_with("node") &&
+            std::from_chars(name.data() + 4, name.data() + name.size(), node)
+                    .ec == std::errc{}) {
+            return node;
+        }
+    }
+
+    return 0;
+}
+
+int bind_memory(void *addr, size_t len, numa_policy policy,
+                std::span<const int> nodes, bool migrate) noexcept {
+    int mode{0};
+    switch (policy) {
+        case numa_policy::bind:
+            mode = MPOL_BIND;
+            break;
+        case numa_policy::interleave:
+            mode = MPOL_INTERLEAVE;
+            break;
+        default:
+            return EINVAL;
+    }
+
+    unsigned long mask[MAX_NODES / BITS_PER_WORD]{};
+    for (const int node : nodes) {
+        if (node < 0 || node >= MAX_NODES) {
+            return EINVAL;
+        }
+        mask[node / BITS_PER_WORD] |= 1UL << (node % BITS_PER_WORD);
+    }
+
+    // The kernel reads maxnode - 1 bits of the mask
+    const unsigned flags = migrate ? MPOL_MF_MOVE : 0;
+    if (syscall(SYS_mbind, addr, len, mode, mask, MAX_NODES + 1, flags) != 0) {
+        return errno;
+    }
+    return 0;
+}
+
+residency page_residency(void *addr, size_t len, size_t page_size) {
+    residency res;
+
+    const size_t num_pages = (len + page_size - 1) / page_size;
+    std::vector<void *> pages;
+    std::vector<int> status;
+    pages.reserve(std::min(num_pages, PAGES_PER_QUERY));
+    status.reserve(std::min(num_pages, PAGES_PER_QUERY));
+
+    auto *base = static_cast<std::byte *>(addr);
+    for (size_t first = 0; first < num_pages; first += PAGES_PER_QUERY) {
+        const size_t count = std::min(PAGES_PER_QUERY, num_pages - first);
+        pages.resize(count);
+        status.assign(count, -ENOENT);
+        for (size_t i = 0; i < count; ++i) {
+            pages[i] = base + (first + i) * page_size;
+        }
+
+        // With no target nodes, move_pages() only reports each page's node
+        if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr,
+                    status.data(), 0) != 0) {
+            const int err = errno;
+            if (err != ENOSYS) {
+                throw std::system_error(err, std::generic_category(),
+                                        "move_pages failed");
+            }
+
+            // No NUMA support: count every page as node 0
+            if (res.pages_per_node.empty()) {
+                res.pages_per_node.resize(1);
+            }
+            res.pages_per_node[0] += count;
+            continue;
+        }
+
+        for (const int node : status) {
+            if (node < 0) {
+                ++res.not_present;
+                continue;
+            }
+            if (static_cast<size_t>(node) >= res.pages_per_node.size()) {
+                res.pages_per_node.resize(node + 1);
+            }
+            ++res.pages_per_node[node];
+        }
+    }
+
+    return res;
+}
+
+}  // namespace cpptools::numa
@@ -3,8 +3,11 @@
 #include <fcntl.h>
 #include <semaphore.h>
 #include <sys/stat.h>
+#include <time.h>
 
 #include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <format>
 #include <iostream>
@@ -12,6 +15,8 @@
 #include <string_view>
 #include <system_error>
 
+#include "cpptools/backoff.hpp"
+
 #define SCESV static constexpr std::string_view
 
 namespace cpptools {
@@ -21,7 +26,9 @@ std::system_error make_sys_err(const int err, const std::string_view what) {
                              what.data());
 }
 
-semaphore_lock::semaphore_lock(std::string_view name) {
+semaphore_lock::semaphore_lock(std::string_view name,
+                               const semaphore_options &options)
+    : m_options(options) {
     if (name.empty() || name.length() > MAX_SEMAPHORE_NAME_LEN) {
         SCESV fmt =
             "Semaphore name \"{}\" of length {} is invalid: length must be in "
@@ -29,12 +36,17 @@ semaphore_lock::semaphore_lock(std::string_view name) {
         throw std::length_error(
             std::format(fmt, name, name.length(), MAX_SEMAPHORE_NAME_LEN));
     }
+    if (options.permits == 0 || options.permits > SEM_VALUE_MAX) {
+        SCESV fmt = "Semaphore \"{}\" permits {} must be in range [1, {}]";
+        throw std::length_error(
+            std::format(fmt, name, options.permits, SEM_VALUE_MAX));
+    }
 
     m_name = name;
 
-    // Open semaphore fd with value 1
-    sem_t *sem =
-        sem_open(m_name.c_str(), O_CREAT | O_EXCL, S_IRUSR + S_IWUSR, 1);
+    // Open semaphore fd with one value per permit
+    sem_t *sem = sem_open(m_name.c_str(), O_CREAT | O_EXCL, S_IRUSR + S_IWUSR,
+                          options.permits);
 
     // Check if failed
     if (sem == SEM_FAILED) {
@@ -76,6 +88,23 @@ semaphore_lock::~semaphore_lock() {
 }
 
 bool semaphore_lock::lock() noexcept {
+    int err{0};
+    return lock(err);
+}
+
+bool semaphore_lock::lock(int &err) noexcept {
+    if (m_owned) return true;
+
+    // Acquire as configured - set error code on failure
+    const bool locked = acquire(err);
+    if (locked) {
+        m_owned = true;
+    }
+
+    return locked;
+}
+
+bool semaphore_lock::try_lock() noexcept {
     if (m_owned) return true;
 
     // Try to lock
@@ -87,20 +116,84 @@ bool semaphore_lock::lock() noexcept {
     return locked;
 }
 
-bool semaphore_lock::lock(int &err) noexcept {
+bool semaphore_lock::lock_until(
+    const std::chrono::steady_clock::time_point deadline) noexcept {
     if (m_owned) return true;
 
-    // Try to lock - set error code on failure
-    const bool locked = (sem_trywait(m_semaphore) == 0);
+    int err{0};
+    const bool locked = wait_until(deadline, err);
     if (locked) {
         m_owned = true;
-    } else {
-        err = errno;
     }
 
     return locked;
 }
 
+bool semaphore_lock::lock_for(const std::chrono::nanoseconds timeout) noexcept {
+    return lock_until(std::chrono::steady_clock::now() + timeout);
+}
+
+bool semaphore_lock::acquire(int &err) noexcept {
+    switch (m_options.mode) {
+        case semaphore_mode::blocking:
+            return wait(err);
+        case semaphore_mode::timed:
+            return wait_until(
+                std::chrono::steady_clock::now() + m_options.timeout, err);
+        case semaphore_mode::spin_then_block:
+            return spin_then_wait(err);
+        default:
+            if (sem_trywait(m_semaphore) == 0) {
+                return true;
+            }
+            err = errno;
+            return false;
+    }
+}
+
+bool semaphore_lock::spin_then_wait(int &err) noexcept {
+    // A permit handed over within the budget is taken without a syscall to
+    // sleep and another to wake up. Backoff stays short, so the budget
+    // bounds the spinning.
+    backoff b(backoff_limits{backoff_limits::DEFAULT_MIN_SPINS, 64});
+    for (uint32_t i = 0; i < m_options.spin_budget; ++i) {
+        if (sem_trywait(m_semaphore) == 0) {
+            return true;
+        }
+        b.pause();
+    }
+    return wait(err);
+}
+
+bool semaphore_lock::wait_until(
+    const std::chrono::steady_clock::time_point deadline, int &err) noexcept {
+    // steady_clock is CLOCK_MONOTONIC, which sem_clockwait takes directly
+    const auto since_epoch = deadline.time_since_epoch();
+    const auto secs = std::chrono::floor<std::chrono::seconds>(since_epoch);
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(secs.count());
+    ts.tv_nsec = static_cast<long>(
+        std::chrono::nanoseconds(since_epoch - secs).count());
+
+    while (sem_clockwait(m_semaphore, CLOCK_MONOTONIC, &ts) != 0) {
+        if (errno != EINTR) {
+            err = errno;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool semaphore_lock::wait(int &err) noexcept {
+    while (sem_wait(m_semaphore) != 0) {
+        if (errno != EINTR) {
+            err = errno;
+            return false;
+        }
+    }
+    return true;
+}
+
 bool semaphore_lock::unlock() noexcept {
     if (!m_owned) {
         return false;
@@ -131,4 +224,16 @@ bool semaphore_lock::unlock(int &err) noexcept {
     return unlocked;
 }
 
+int semaphore_lock::available() const noexcept {
+    int value{0};
+    if (sem_getvalue(m_semaphore, &value) != 0) {
+        return -1;
+    }
+    return value;
+}
+
+bool semaphore_lock::remove(std::string_view name) noexcept {
+    return sem_unlink(std::string(name).c_str()) == 0;
+}
+
 }  // namespace cpptools
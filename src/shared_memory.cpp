@@ -1,71 +1,540 @@
 #include "cpptools/shared_memory.hpp"
 
 #include <fcntl.h>
+#include <linux/magic.h>
+#include <signal.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cerrno>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
 
-#include "cpptools/semaphore_lock.hpp"
+#include "cpptools/backoff.hpp"
+#include "cpptools/numa.hpp"
 
 #define SCESV static constexpr std::string_view
 
+#ifndef MFD_HUGE_SHIFT
+#define MFD_HUGE_SHIFT 26
+#endif
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
 namespace cpptools {
 
-shared_memory::shared_memory(const std::string_view name,
-                             const size_t requestedSize)
-    : m_data_size(requestedSize),
-      m_total_size(requestedSize + REF_COUNT_OFFSET),
-      m_semlock(name) {
-    // Validate args
-    if (name.empty() || name.length() > MAX_NAME_LEN) {
+namespace {
+
+size_t huge_page_bytes(page_size pages) {
+    switch (pages) {
+        case page_size::huge_2mb:
+            return size_t{2} << 20;
+        case page_size::huge_1gb:
+            return size_t{1} << 30;
+        default:
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+}
+
+size_t round_up(size_t size, size_t multiple) {
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+// Parses a hugetlbfs "pagesize=" mount option, e.g. "2M" or "1G"
+size_t parse_page_size_option(std::string_view value) {
+    size_t bytes{0};
+    size_t i{0};
+    for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; ++i) {
+        bytes = bytes * 10 + (value[i] - '0');
+    }
+
+    if (i < value.size()) {
+        switch (value[i]) {
+            case 'K':
+            case 'k':
+                return bytes << 10;
+            case 'M':
+            case 'm':
+                return bytes << 20;
+            case 'G':
+            case 'g':
+                return bytes << 30;
+        }
+    }
+    return bytes;
+}
+
+// Default huge page size from /proc/meminfo, used by hugetlbfs mounts that
+// don't specify one
+size_t default_huge_page_bytes() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    size_t kib{0};
+    while (meminfo >> key) {
+        if (key == "Hugepagesize:") {
+            meminfo >> kib;
+            return kib << 10;
+        }
+        meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+}
+
+// Finds a hugetlbfs mount point with the given page size
+std::string find_hugetlbfs_mount(size_t bytes) {
+    std::ifstream mounts("/proc/mounts");
+    std::string line;
+    while (std::getline(mounts, line)) {
+        std::istringstream fields(line);
+        std::string device, mount_point, fs_type, mount_options;
+        fields >> device >> mount_point >> fs_type >> mount_options;
+        if (fs_type != "hugetlbfs") {
+            continue;
+        }
+
+        size_t mount_bytes = default_huge_page_bytes();
+        const size_t pos = mount_options.find("pagesize=");
+        if (pos != std::string::npos) {
+            const size_t start = pos + std::strlen("pagesize=");
+            const size_t end = mount_options.find(',', start);
+            mount_bytes = parse_page_size_option(
+                std::string_view(mount_options).substr(start, end - start));
+        }
+
+        if (mount_bytes == bytes) {
+            return mount_point;
+        }
+    }
+    return {};
+}
+
+// Number of huge pages of the given size that are free and not reserved
+size_t available_huge_pages(size_t bytes) {
+    const std::string dir =
+        std::format("/sys/kernel/mm/hugepages/hugepages-{}kB/", bytes >> 10);
+
+    size_t free{0};
+    size_t reserved{0};
+    std::ifstream(dir + "free_hugepages") >> free;
+    std::ifstream(dir + "resv_hugepages") >> reserved;
+    return free > reserved ? free - reserved : 0;
+}
+
+void validate_name(std::string_view name) {
+    if (name.empty() || name.length() > shared_memory::MAX_NAME_LEN) {
         throw std::length_error(
             std::format("Shared memory name \"{}\" of length {} is invalid: "
                         "length must be in range [1, {}]\n",
-                        name, name.length(), MAX_NAME_LEN));
+                        name, name.length(), shared_memory::MAX_NAME_LEN));
     }
+}
+
+void validate_size(std::string_view name, size_t requestedSize,
+                   const shared_memory_options &options) {
     if (requestedSize == 0) {
         throw std::logic_error("Requested 0 bytes of shared memory");
     }
+    if (options.max_size != 0 && options.max_size < requestedSize) {
+        throw std::length_error(std::format(
+            "Shared memory \"{}\" max_size {} is less than requested size {}",
+            name, options.max_size, requestedSize));
+    }
+}
+
+// Label a memfd was created with, from its /proc/self/fd link, which reads
+// "/memfd:<label> (deleted)"
+std::string memfd_label(int fd) {
+    char link[PATH_MAX]{};
+    const std::string path = std::format("/proc/self/fd/{}", fd);
+    const ssize_t len = readlink(path.c_str(), link, sizeof(link) - 1);
+    if (len <= 0) {
+        return std::format("memfd {}", fd);
+    }
+
+    std::string_view label(link, static_cast<size_t>(len));
+    if (label.starts_with("/memfd:")) {
+        label.remove_prefix(std::strlen("/memfd:"));
+    }
+    if (label.ends_with(" (deleted)")) {
+        label.remove_suffix(std::strlen(" (deleted)"));
+    }
+    return std::string(label);
+}
+
+}  // namespace
+
+shared_memory::shared_memory(const std::string_view name,
+                             const size_t requestedSize,
+                             const shared_memory_options &options)
+    : m_data_size(requestedSize),
+      m_total_size(requestedSize + REF_COUNT_OFFSET),
+      m_page_size(huge_page_bytes(page_size::normal)),
+      m_options(options) {
+    // Validate args
+    validate_name(name);
+    validate_size(name, requestedSize, options);
+
+    // Copy name
+    m_name = name;
+
+    // Huge pages require the mapping to be a whole number of pages
+    if (options.pages != page_size::normal) {
+        select_huge_pages(name, options);
+    }
+
+    create_or_attach(name);
+}
+
+shared_memory::shared_memory(memfd_t, const std::string_view name,
+                             const size_t requestedSize,
+                             const shared_memory_options &options)
+    : m_data_size(requestedSize),
+      m_total_size(requestedSize + REF_COUNT_OFFSET),
+      m_page_size(huge_page_bytes(page_size::normal)),
+      m_options(options),
+      m_anonymous(true) {
+    // Validate args
+    validate_name(name);
+    validate_size(name, requestedSize, options);
+
+    // Copy name
+    m_name = name;
+
+    // memfd allocates huge pages itself, no hugetlbfs mount needed
+    unsigned int flags = MFD_CLOEXEC | MFD_ALLOW_SEALING;
+    if (options.pages != page_size::normal) {
+        const size_t bytes = huge_page_bytes(options.pages);
+        const size_t needed = round_up(m_total_size, bytes) / bytes;
+        const size_t available = available_huge_pages(bytes);
+        if (available < needed) {
+            m_fallback_reason =
+                std::format("{} huge pages of {} KiB needed, {} available",
+                            needed, bytes >> 10, available);
+            std::cerr << std::format(
+                "Shared memory \"{}\" falls back to normal pages: {}\n", name,
+                m_fallback_reason);
+        } else {
+            const unsigned int shift = std::countr_zero(bytes);
+            flags |= MFD_HUGETLB | (shift << MFD_HUGE_SHIFT);
+            m_page_size = bytes;
+            m_total_size = round_up(m_total_size, bytes);
+            m_huge_pages = true;
+        }
+    }
 
-    // If we can't open shared memory at m_Name
-    if (!open_shared_mem_file(name)) {
-        // Try to create it
-        alloc_shared_mem(name);
+    const int fileDesc = memfd_create(m_name.c_str(), flags);
+    if (fileDesc == -1) {
+        const int err = errno;
+        throw std::runtime_error(std::format(
+            "Failed to create shared memory \"{}\": {}", name, strerror(err)));
+    }
+    m_file_desc = fileDesc;
 
-        // If we succeeded in creating it (i.e. didn't crash) but still can't
-        // open it, then fail
-        if (!open_shared_mem_file(name)) {
+    try {
+        // Allocate m_total_size bytes
+        if (ftruncate(m_file_desc, m_total_size) == -1) {
             const int err = errno;
             throw std::runtime_error(
-                std::format("Failed to open shared memory \"{}\": {}", name,
+                std::format("Failed to allocate shared memory \"{}\": {}",
+                            name, strerror(err)));
+        }
+
+        attach(name, true, attach_deadline());
+    } catch (...) {
+        close_shared_mem_file();
+        throw;
+    }
+}
+
+shared_memory::shared_memory(memfd_t, const int fd, const size_t requestedSize,
+                             const shared_memory_options &options)
+    : m_data_size(requestedSize),
+      m_total_size(requestedSize + REF_COUNT_OFFSET),
+      m_page_size(huge_page_bytes(page_size::normal)),
+      m_options(options),
+      m_anonymous(true) {
+    // Keep our own descriptor, so the caller can close theirs
+    const int fileDesc = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (fileDesc == -1) {
+        const int err = errno;
+        throw std::runtime_error(
+            std::format("Failed to attach to shared memory descriptor {}: {}",
+                        fd, strerror(err)));
+    }
+    m_file_desc = fileDesc;
+
+    try {
+        m_name = memfd_label(m_file_desc);
+        validate_size(m_name, requestedSize, options);
+
+        // Huge pages are a property of the segment
+        struct statfs fs;
+        if (fstatfs(m_file_desc, &fs) == 0 && fs.f_type == HUGETLBFS_MAGIC) {
+            m_page_size = static_cast<size_t>(fs.f_bsize);
+            m_total_size = round_up(m_total_size, m_page_size);
+            m_huge_pages = true;
+        }
+
+        check_existing_size(m_name, m_file_desc);
+        if (!attach(m_name, false, attach_deadline())) {
+            throw std::runtime_error(std::format(
+                "Shared memory \"{}\" is being destroyed", m_name));
+        }
+    } catch (...) {
+        close_shared_mem_file();
+        throw;
+    }
+}
+
+void shared_memory::create_or_attach(std::string_view name) {
+    const auto deadline = attach_deadline();
+    backoff b;
+    while (true) {
+        // Whoever creates the file initializes the segment
+        int fileDesc = open_file(name, O_RDWR | O_CREAT | O_EXCL);
+        if (fileDesc != -1) {
+            m_file_desc = fileDesc;
+            try {
+                // Allocate m_total_size bytes
+                if (ftruncate(m_file_desc, m_total_size) == -1) {
+                    const int err = errno;
+                    throw std::runtime_error(std::format(
+                        "Failed to allocate shared memory \"{}\": {}", name,
+                        strerror(err)));
+                }
+                attach(name, true, deadline);
+            } catch (...) {
+                // Unless attach() detached already, take the file away
+                // from the processes waiting on it
+                if (m_file_desc != -1) {
+                    unlink_file();
+                    close_shared_mem_file();
+                }
+                throw;
+            }
+            return;
+        }
+        if (errno != EEXIST) {
+            const int err = errno;
+            throw std::runtime_error(
+                std::format("Failed to create shared memory \"{}\": {}", name,
                             strerror(err)));
         }
+
+        // Someone else created it: attach, unless it went away meanwhile
+        fileDesc = open_file(name, O_RDWR);
+        if (fileDesc == -1) {
+            if (errno != ENOENT) {
+                const int err = errno;
+                throw std::runtime_error(
+                    std::format("Failed to open shared memory \"{}\": {}",
+                                name, strerror(err)));
+            }
+            continue;
+        }
+        m_file_desc = fileDesc;
+        try {
+            if (wait_for_size(name, deadline) &&
+                attach(name, false, deadline)) {
+                return;
+            }
+        } catch (...) {
+            close_shared_mem_file();
+            throw;
+        }
+        close_shared_mem_file();
+
+        // It was being destroyed, or its creator gave up: start over
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error(std::format(
+                "Timed out attaching to shared memory \"{}\"", name));
+        }
+        b.pause_or_yield();
     }
+}
 
+bool shared_memory::wait_for_size(std::string_view name,
+                                  const time_point deadline) {
+    // The creator sizes the file right after creating it
+    backoff b;
+    struct stat buf;
+    while (true) {
+        if (fstat(m_file_desc, &buf) == -1) {
+            const int err = errno;
+            throw std::runtime_error(std::format(
+                "fstat failed for shared memory {}: {}", name, strerror(err)));
+        }
+        if (buf.st_nlink == 0) {
+            // Unlinked: the creator gave up
+            return false;
+        }
+        if (buf.st_size != 0) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error(std::format(
+                "Timed out waiting for shared memory \"{}\" to be created",
+                name));
+        }
+        b.pause_or_yield();
+    }
+
+    check_existing_size(name, m_file_desc);
+    return true;
+}
+
+bool shared_memory::attach(std::string_view name, const bool creator,
+                           const time_point deadline) {
     // Map the data to our virtual memory
     map_shared_mem(name);
+    const std::atomic_ref<init_state> state(m_header->state);
 
-    // Copy name
-    m_name = name;
+    // The creator's NUMA policy places the segment before anything touches
+    // it, the header page included, so it's in place before anyone else
+    // gets in. If that fails, nobody else has seen the segment and it's
+    // marked failed for those waiting on it.
+    if (creator) {
+        try {
+            apply_numa_policy(name);
+        } catch (...) {
+            state.store(init_state::failed, std::memory_order_release);
+            unmap_shared_mem();
+            throw;
+        }
+        std::atomic_ref<pid_t>(m_header->creator)
+            .store(getpid(), std::memory_order_relaxed);
+    } else {
+        // Everyone else waits for the creator to initialize the segment
+        const init_state s = wait_until_initialized(deadline);
+        if (s == init_state::failed) {
+            unmap_shared_mem();
+            return false;
+        }
+        if (s != init_state::ready) {
+            unmap_shared_mem();
+            throw std::runtime_error(std::format(
+                "Timed out waiting for shared memory \"{}\" to be initialized",
+                name));
+        }
+    }
+
+    // Increment ref counter. A named segment whose count is zero is being
+    // destroyed by the last process that used it: never count ourselves in,
+    // even for a moment, and let the caller start over. An anonymous one
+    // lives on while anyone holds a descriptor, so joining it is fine.
+    const std::atomic_ref<int> refCounter(m_header->reference_count);
+    if (creator || m_anonymous) {
+        refCounter.fetch_add(1, std::memory_order_acq_rel);
+    } else {
+        int count = refCounter.load(std::memory_order_acquire);
+        while (count != 0 &&
+               !refCounter.compare_exchange_weak(count, count + 1,
+                                                 std::memory_order_acq_rel)) {
+        }
+        if (count == 0) {
+            unmap_shared_mem();
+            return false;
+        }
+    }
 
-    // Increment ref counter
-    const std::atomic_ref<int> refCounter(*m_reference_count);
-    refCounter.fetch_add(1, std::memory_order_release);
+    // A grown segment is as large as its last grow() asked for
+    if (growable()) {
+        m_data_size = std::max(m_data_size, grown_size());
+    }
+
+    // Let the others in; they apply the policy to their own mapping too
+    if (creator) {
+        state.store(init_state::ready, std::memory_order_release);
+    } else {
+        try {
+            apply_numa_policy(name);
+        } catch (...) {
+            detach();
+            throw;
+        }
+    }
+
+    // Paging in is up to each process: on failure, only this one detaches
+    try {
+        page_in(name, reinterpret_cast<std::byte *>(m_header), m_total_size);
+    } catch (...) {
+        detach();
+        throw;
+    }
+    return true;
 }
 
-shared_memory::~shared_memory() {
+shared_memory::init_state shared_memory::wait_until_initialized(
+    const time_point deadline) const noexcept {
+    const std::atomic_ref<init_state> state(m_header->state);
+    backoff b;
+    init_state s = state.load(std::memory_order_acquire);
+    while (s == init_state::initializing) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+
+        // Once spinning gets slow, also look out for a creator that gave up
+        // or died before it could say so
+        if (b.spins() >= backoff_limits::DEFAULT_MAX_SPINS && !m_anonymous) {
+            struct stat buf;
+            if (fstat(m_file_desc, &buf) == 0 && buf.st_nlink == 0) {
+                return init_state::failed;
+            }
+            if (creator_died()) {
+                // Whoever marks it failed first takes the name away, so
+                // the segment a retry creates isn't removed by another
+                // waiter. The rest start over once the name is gone.
+                if (state.compare_exchange_strong(
+                        s, init_state::failed, std::memory_order_acq_rel)) {
+                    unlink_file();
+                }
+                return init_state::failed;
+            }
+        }
+        b.pause_or_yield();
+        s = state.load(std::memory_order_acquire);
+    }
+    return s;
+}
+
+bool shared_memory::creator_died() const noexcept {
+    // Assumes the processes sharing the segment share a pid namespace. A
+    // creator whose pid has been reused looks alive, and waiters time out.
+    const pid_t pid = std::atomic_ref<pid_t>(m_header->creator)
+                          .load(std::memory_order_relaxed);
+    return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+shared_memory::time_point shared_memory::attach_deadline() const {
+    return std::chrono::steady_clock::now() + m_options.attach_timeout;
+}
+
+shared_memory::~shared_memory() { detach(); }
+
+void shared_memory::detach() noexcept {
     // Check before dereferencing
-    if (m_reference_count != nullptr) {
-        const std::atomic_ref<int> refCounter(*m_reference_count);
+    if (m_header != nullptr) {
+        const std::atomic_ref<int> refCounter(m_header->reference_count);
 
         // Decrement ref counter, and capture value before CAS operation
         const int refCount =
@@ -74,8 +543,9 @@ shared_memory::~shared_memory() {
         // Unmap from process virt mem
         unmap_shared_mem();
 
-        // If ref count is 0, schedule free
-        if (refCount == 0) {
+        // If ref count is 0, schedule free. Anonymous segments go away with
+        // their last descriptor.
+        if (refCount == 0 && !m_anonymous) {
             free_shared_mem();
         }
     }
@@ -86,24 +556,196 @@ shared_memory::~shared_memory() {
 
 int shared_memory::reference_count() const {
     int refCount{-1};
-    if (m_reference_count != nullptr) {
-        refCount = std::atomic_ref<int>(*m_reference_count)
+    if (m_header != nullptr) {
+        refCount = std::atomic_ref<int>(m_header->reference_count)
                        .load(std::memory_order_acquire);
     }
     return refCount;
 }
 
-bool shared_memory::open_shared_mem_file(std::string_view name) {
-    // Try to open shared memory file
-    const int file_desc = shm_open(name.data(), O_RDWR, S_IRUSR + S_IWUSR);
-    if (file_desc == -1) {
-        // Failed
+uint64_t shared_memory::generation() const {
+    if (m_header == nullptr) {
+        return 0;
+    }
+    return std::atomic_ref<uint64_t>(m_header->generation)
+        .load(std::memory_order_acquire);
+}
+
+size_t shared_memory::grown_size() {
+    // Read the generation first: a size from the same or a later grow()
+    // is at least as large as what it mapped
+    m_generation = generation();
+    const size_t grown = std::atomic_ref<uint64_t>(m_header->data_size)
+                             .load(std::memory_order_relaxed);
+    return std::min(grown, m_total_size - REF_COUNT_OFFSET);
+}
+
+bool shared_memory::grow(const size_t new_size) {
+    if (!growable()) {
+        throw std::logic_error(
+            std::format("Shared memory \"{}\" is not growable", m_name));
+    }
+    if (new_size > m_options.max_size) {
+        throw std::length_error(
+            std::format("Can't grow shared memory \"{}\" to {} bytes: "
+                        "max_size is {}",
+                        m_name, new_size, m_options.max_size));
+    }
+
+    // Keep other processes from growing it at the same time
+    if (!lock_growth()) {
+        return false;
+    }
+
+    try {
+        // Catch up first, so m_total_size is the file's size
+        refresh();
+
+        if (new_size > m_data_size) {
+            const size_t total_size =
+                round_up(new_size + REF_COUNT_OFFSET, m_page_size);
+            if (total_size > m_total_size) {
+                if (ftruncate(m_file_desc, total_size) == -1) {
+                    const int err = errno;
+                    throw std::runtime_error(
+                        std::format("Failed to grow shared memory \"{}\": {}",
+                                    m_name, strerror(err)));
+                }
+                map_growth(total_size);
+            }
+
+            // Publish the new size to attached processes
+            std::atomic_ref<uint64_t>(m_header->data_size)
+                .store(new_size, std::memory_order_relaxed);
+            m_generation = std::atomic_ref<uint64_t>(m_header->generation)
+                               .fetch_add(1, std::memory_order_release) +
+                           1;
+            m_data_size = new_size;
+        }
+    } catch (...) {
+        unlock_growth();
+        throw;
+    }
+
+    unlock_growth();
+    return true;
+}
+
+bool shared_memory::lock_growth() noexcept {
+    uint32_t unlocked{0};
+    return std::atomic_ref<uint32_t>(m_header->grow_lock)
+        .compare_exchange_strong(unlocked, 1, std::memory_order_acquire);
+}
+
+void shared_memory::unlock_growth() noexcept {
+    std::atomic_ref<uint32_t>(m_header->grow_lock)
+        .store(0, std::memory_order_release);
+}
+
+void shared_memory::seal(const int seals) {
+    if (fcntl(m_file_desc, F_ADD_SEALS, seals) == -1) {
         const int err = errno;
-        std::cerr << std::format("Failed to open shared memory \"{}\": {}\n",
-                                 m_name, strerror(err));
+        throw std::system_error(
+            err, std::system_category(),
+            std::format("Failed to seal shared memory \"{}\"", m_name));
+    }
+}
+
+int shared_memory::seals() const {
+    const int seals = fcntl(m_file_desc, F_GET_SEALS);
+    return seals == -1 ? 0 : seals;
+}
+
+bool shared_memory::refresh() {
+    if (!growable() || generation() == m_generation) {
         return false;
     }
 
+    struct stat buf;
+    if (fstat(m_file_desc, &buf) == -1) {
+        const int err = errno;
+        throw std::runtime_error(
+            std::format("fstat failed for shared memory \"{}\": {}", m_name,
+                        strerror(err)));
+    }
+
+    // A process with a larger max_size may have grown it past ours
+    const size_t total_size =
+        std::min(static_cast<size_t>(buf.st_size), m_reserved_size);
+    if (total_size > m_total_size) {
+        map_growth(total_size);
+    }
+
+    const size_t old_size = m_data_size;
+    m_data_size = std::max(m_data_size, grown_size());
+    return m_data_size != old_size;
+}
+
+void shared_memory::select_huge_pages(std::string_view name,
+                                      const shared_memory_options &options) {
+    const size_t bytes = huge_page_bytes(options.pages);
+
+    const std::string mount = options.hugetlbfs_mount.empty()
+                                  ? find_hugetlbfs_mount(bytes)
+                                  : options.hugetlbfs_mount;
+    struct statfs fs;
+    if (mount.empty()) {
+        m_fallback_reason =
+            std::format("no hugetlbfs mount with {} KiB pages", bytes >> 10);
+    } else if (statfs(mount.c_str(), &fs) != 0 ||
+               fs.f_type != HUGETLBFS_MAGIC) {
+        m_fallback_reason =
+            std::format("\"{}\" is not a hugetlbfs mount", mount);
+    } else {
+        const std::string path = mount + std::string(name);
+        const size_t needed = round_up(m_total_size, bytes) / bytes;
+        const size_t available = available_huge_pages(bytes);
+
+        struct stat buf;
+        if (stat(path.c_str(), &buf) == 0) {
+            // Attach to the existing huge page segment
+            m_path = path;
+        } else if (const int fd = shm_open(name.data(), O_RDONLY, 0);
+                   fd != -1) {
+            // Another process already created the segment, and fell back
+            close(fd);
+            m_fallback_reason = "segment already exists with normal pages";
+        } else if (available < needed) {
+            m_fallback_reason =
+                std::format("{} huge pages of {} KiB needed, {} available",
+                            needed, bytes >> 10, available);
+        } else {
+            m_path = path;
+        }
+    }
+
+    if (m_path.empty()) {
+        std::cerr << std::format(
+            "Shared memory \"{}\" falls back to normal pages: {}\n", name,
+            m_fallback_reason);
+    } else {
+        m_page_size = bytes;
+        m_total_size = round_up(m_total_size, bytes);
+        m_huge_pages = true;
+    }
+}
+
+int shared_memory::open_file(std::string_view name, int flags) const noexcept {
+    if (m_path.empty()) {
+        return shm_open(name.data(), flags, S_IRUSR + S_IWUSR);
+    }
+    return open(m_path.c_str(), flags, S_IRUSR + S_IWUSR);
+}
+
+int shared_memory::unlink_file() const noexcept {
+    if (m_path.empty()) {
+        return shm_unlink(m_name.c_str());
+    }
+    return unlink(m_path.c_str());
+}
+
+void shared_memory::check_existing_size(std::string_view name,
+                                        const int file_desc) {
     // Get file info
     struct stat buf;
     if (fstat(file_desc, &buf) == -1) {
@@ -113,19 +755,34 @@ bool shared_memory::open_shared_mem_file(std::string_view name) {
             "fstat failed for shared memory {}: {}", name, strerror(err)));
     }
 
+    // A growable segment may have been grown since, up to its max_size
+    const auto existing_size = static_cast<size_t>(buf.st_size);
+    if (m_options.max_size != 0 && existing_size >= m_total_size) {
+        const size_t max_total_size =
+            round_up(m_options.max_size + REF_COUNT_OFFSET, m_page_size);
+        if (existing_size > max_total_size) {
+            throw std::runtime_error(std::format(
+                "Shared memory \"{}\" exists, but is larger than max_size: "
+                "{} existing vs. {} max",
+                name, existing_size, max_total_size));
+        }
+        m_total_size = existing_size;
+    }
+
     // Check that existing shared memory's size is what's expected
-    if (static_cast<size_t>(buf.st_size) != m_total_size) {
+    if (existing_size != m_total_size) {
         throw std::runtime_error(
             std::format("Shared memory \"{}\" exists, but size does not match: "
                         "{} requested vs. {} existing",
                         name, m_total_size, buf.st_size));
     }
-
-    m_file_desc = file_desc;
-    return true;
 }
 
 void shared_memory::close_shared_mem_file() noexcept {
+    if (m_file_desc == -1) {
+        return;
+    }
+
     if (close(m_file_desc) == -1) {
         // Failed
         const int err = errno;
@@ -137,72 +794,244 @@ void shared_memory::close_shared_mem_file() noexcept {
     m_file_desc = -1;
 }
 
-void shared_memory::alloc_shared_mem(std::string_view name) {
-    // Try to lock semaphore
-    if (!m_semlock.lock()) {
-        return;
+void shared_memory::free_shared_mem() noexcept {
+    if (unlink_file() == -1) {
+        // Failed
+        const int err = errno;
+        std::cerr << std::format("Failed to free shared memory \"{}\": {}\n",
+                                 m_name, strerror(err));
     }
+}
 
-    // Create new shared memory in system
-    const int fileDesc =
-        shm_open(name.data(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR + S_IWUSR);
-    if (fileDesc == -1) {
-        // Failed
+void shared_memory::map_shared_mem(std::string_view name) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Map shared memory to our process's virtual memory. With a NUMA policy,
+    // populating has to wait until the policy is in place.
+    const bool populate =
+        m_options.populate && m_options.numa == numa_policy::none;
+    int flags = MAP_SHARED | (populate ? MAP_POPULATE : 0);
+
+    // Growable segments are mapped at the start of an address range
+    // reserved for max_size, aligned to the page size, so they can grow in
+    // place
+    void *addr{nullptr};
+    size_t reserved_size{0};
+    if (m_options.max_size != 0) {
+        reserved_size =
+            round_up(m_options.max_size + REF_COUNT_OFFSET, m_page_size);
+        void *range = mmap(nullptr, reserved_size + m_page_size, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (range == MAP_FAILED) {
+            const int err = errno;
+            throw std::runtime_error(
+                std::format("Failed to reserve {} bytes for shared memory "
+                            "\"{}\": {}",
+                            reserved_size, name, strerror(err)));
+        }
+
+        // Give back what's outside the aligned range
+        auto *begin = reinterpret_cast<std::byte *>(range);
+        auto *aligned = reinterpret_cast<std::byte *>(
+            round_up(reinterpret_cast<uintptr_t>(begin), m_page_size));
+        if (aligned != begin) {
+            munmap(begin, aligned - begin);
+        }
+        munmap(aligned + reserved_size, begin + m_page_size - aligned);
+
+        addr = aligned;
+        flags |= MAP_FIXED;
+    }
+
+    void *data = mmap(addr, m_total_size, PROT_READ | PROT_WRITE, flags,
+                      m_file_desc, 0);
+    m_timings.map = std::chrono::steady_clock::now() - start;
+    if (data == MAP_FAILED) {
+        // Failed to map
         const int err = errno;
+        if (addr != nullptr) {
+            munmap(addr, reserved_size);
+        }
         throw std::runtime_error(std::format(
-            "Failed to create shared memory \"{}\": {}", name, strerror(err)));
+            "Failed to map shared memory \"{}\": {}", name, strerror(err)));
     }
 
-    // Allocate m_Size bytes
-    if (ftruncate(fileDesc, m_total_size) == -1) {
-        // Failed
+    // Header with the reference counter lives at the start of the mapping,
+    // data starts REF_COUNT_OFFSET bytes after it
+    m_header = reinterpret_cast<header *>(data);
+    m_data = reinterpret_cast<std::byte *>(data) + REF_COUNT_OFFSET;
+    m_reserved_size = reserved_size;
+}
+
+void shared_memory::map_growth(const size_t total_size) {
+    using clock = std::chrono::steady_clock;
+
+    // Map from the start of the page the old end falls in. Mapping a page
+    // of the file over itself keeps its contents.
+    const size_t offset = m_total_size / m_page_size * m_page_size;
+    std::byte *addr = reinterpret_cast<std::byte *>(m_header) + offset;
+    const size_t len = total_size - offset;
+
+    m_timings = {};
+    const auto start = clock::now();
+    const bool populate =
+        m_options.populate && m_options.numa == numa_policy::none;
+    const int flags = MAP_SHARED | MAP_FIXED | (populate ? MAP_POPULATE : 0);
+    void *data = mmap(addr, len, PROT_READ | PROT_WRITE, flags, m_file_desc,
+                      static_cast<off_t>(offset));
+    m_timings.map = clock::now() - start;
+    if (data == MAP_FAILED) {
         const int err = errno;
         throw std::runtime_error(
-            std::format("Failed to allocate shared memory \"{}\": {}", name,
-                        strerror(err)));
+            std::format("Failed to map growth of shared memory \"{}\": {}",
+                        m_name, strerror(err)));
     }
+    m_total_size = total_size;
 
-    m_semlock.unlock();
+    // Same placement and page-in as the rest of the segment
+    if (!m_numa_nodes.empty()) {
+        const auto numa_start = clock::now();
+        const numa_policy policy = m_options.numa == numa_policy::interleave
+                                       ? numa_policy::interleave
+                                       : numa_policy::bind;
+        const int err = numa::bind_memory(addr, len, policy, m_numa_nodes);
+        m_timings.numa = clock::now() - numa_start;
+        if (err != 0) {
+            throw std::runtime_error(
+                std::format("mbind failed for shared memory \"{}\": {}",
+                            m_name, strerror(err)));
+        }
+    }
+    page_in(m_name, addr, len);
 }
 
-void shared_memory::free_shared_mem() noexcept {
-    // Try to lock semaphore before unlinking
-    if (!m_semlock.lock()) {
-        std::cerr << std::format(
-            "Failed to free shared memory \"{}\": can't lock semaphore\n",
-            m_name);
+numa::residency shared_memory::numa_residency() const {
+    if (m_header == nullptr) {
+        return {};
+    }
+    return numa::page_residency(m_header, m_total_size, m_page_size);
+}
+
+void shared_memory::apply_numa_policy(std::string_view name) {
+    if (m_options.numa == numa_policy::none) {
         return;
     }
 
-    if (shm_unlink(m_name.c_str()) == -1) {
-        // Failed
-        const int err = errno;
-        std::cerr << std::format("Failed to free shared memory \"{}\": {}\n",
-                                 m_name, strerror(err));
+    const auto start = std::chrono::steady_clock::now();
+
+    // Resolve the requested nodes
+    std::vector<int> requested = m_options.numa_nodes;
+    numa_policy policy = m_options.numa;
+    if (policy == numa_policy::local_to_core) {
+        const int node = numa::node_of_cpu(m_options.numa_core);
+        if (node < 0) {
+            m_numa_fallback_reason =
+                std::format("core {} does not exist", m_options.numa_core);
+            return;
+        }
+        requested = {node};
+        policy = numa_policy::bind;
+    }
+
+    // Keep the ones that are online
+    const std::vector<int> online = numa::online_nodes();
+    for (const int node : requested) {
+        if (std::find(online.begin(), online.end(), node) != online.end()) {
+            m_numa_nodes.push_back(node);
+        } else {
+            m_numa_fallback_reason +=
+                std::format("{}node {} is not online",
+                            m_numa_fallback_reason.empty() ? "" : ", ", node);
+        }
+    }
+    if (m_numa_nodes.empty()) {
+        m_numa_fallback_reason += m_numa_fallback_reason.empty()
+                                      ? "no NUMA nodes requested"
+                                      : ", policy skipped";
         return;
     }
 
-    m_semlock.unlock();
+    const int err =
+        numa::bind_memory(m_header, m_total_size, policy, m_numa_nodes);
+    m_timings.numa = std::chrono::steady_clock::now() - start;
+    if (err == ENOSYS) {
+        // Kernel built without NUMA support
+        m_numa_fallback_reason = "kernel has no NUMA support";
+        m_numa_nodes.clear();
+    } else if (err != 0) {
+        throw std::runtime_error(
+            std::format("mbind failed for shared memory \"{}\": {}", name,
+                        strerror(err)));
+    }
 }
 
-void shared_memory::map_shared_mem(std::string_view name) {
-    // Map shared memory to our process's virtual memory
-    void *data = mmap(nullptr, m_total_size, PROT_READ | PROT_WRITE, MAP_SHARED,
-                      m_file_desc, 0);
-    if (data == MAP_FAILED) {
-        // Failed to map
-        const int err = errno;
+void shared_memory::page_in(std::string_view name, std::byte *addr,
+                            const size_t len) {
+    using clock = std::chrono::steady_clock;
+
+    if (m_options.advice != MADV_NORMAL) {
+        const auto start = clock::now();
+        const int ret = madvise(addr, len, m_options.advice);
+        m_timings.advise = clock::now() - start;
+        if (ret != 0) {
+            const int err = errno;
+            throw std::runtime_error(
+                std::format("madvise({}) failed for shared memory \"{}\": {}",
+                            m_options.advice, name, strerror(err)));
+        }
+    }
+
+    // Populate deferred from map time, see map_shared_mem()
+    const bool populate =
+        m_options.populate && m_options.numa != numa_policy::none;
+    if (m_options.prefault || populate) {
+        const auto start = clock::now();
+        prefault_pages(name, addr, len);
+        m_timings.prefault = clock::now() - start;
+    }
+
+    if (m_options.lock_pages) {
+        const auto start = clock::now();
+        const int ret = mlock(addr, len);
+        m_timings.lock = clock::now() - start;
+        if (ret != 0) {
+            const int err = errno;
+            throw std::runtime_error(
+                std::format("mlock failed for shared memory \"{}\": {}", name,
+                            strerror(err)));
+        }
+    }
+}
+
+void shared_memory::prefault_pages(std::string_view name, std::byte *addr,
+                                   const size_t len) {
+    // Write-fault everything in one syscall (Linux 5.14+)
+    if (madvise(addr, len, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+
+    // Only a kernel without it (EINVAL) falls back to touching pages. Other
+    // errors, e.g. ENOMEM, would crash the process on the touch instead.
+    const int err = errno;
+    if (err != EINVAL) {
         throw std::runtime_error(std::format(
-            "Failed to map shared memory \"{}\": {}", name, strerror(err)));
+            "madvise(MADV_POPULATE_WRITE) failed for shared memory \"{}\": {}",
+            name, strerror(err)));
     }
 
-    m_reference_count = reinterpret_cast<int *>(data);
-    m_data = reinterpret_cast<void *>(m_reference_count + REF_COUNT_OFFSET);
+    // Otherwise touch each page. Other processes may be writing to the
+    // segment, so use an atomic no-op RMW rather than a plain write.
+    auto *bytes = reinterpret_cast<unsigned char *>(addr);
+    for (size_t offset = 0; offset < len; offset += m_page_size) {
+        std::atomic_ref<unsigned char>(bytes[offset])
+            .fetch_add(0, std::memory_order_relaxed);
+    }
 }
 
 void shared_memory::unmap_shared_mem() noexcept {
-    if (munmap(reinterpret_cast<void *>(m_reference_count), m_total_size) !=
-        0) {
+    // A growable segment's reserved range goes with it
+    const size_t size = growable() ? m_reserved_size : m_total_size;
+    if (munmap(m_header, size) != 0) {
         // Failed to unmap
         const int err = errno;
         std::cerr << std::format("Failed to unmap shared memory \"{}\": {}\n",
@@ -210,8 +1039,72 @@ void shared_memory::unmap_shared_mem() noexcept {
         return;
     }
 
-    m_reference_count = nullptr;
+    m_header = nullptr;
     m_data = nullptr;
+    m_reserved_size = 0;
+}
+
+void send_fd(const int socket, const int fd) {
+    // One byte of data carries the descriptor as SCM_RIGHTS ancillary data
+    char byte{0};
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    if (sendmsg(socket, &msg, MSG_NOSIGNAL) == -1) {
+        const int err = errno;
+        throw std::system_error(
+            err, std::system_category(),
+            std::format("Failed to send descriptor {} over socket {}", fd,
+                        socket));
+    }
+}
+
+int receive_fd(const int socket) {
+    char byte{0};
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t received = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    if (received == -1) {
+        const int err = errno;
+        throw std::system_error(
+            err, std::system_category(),
+            std::format("Failed to receive descriptor over socket {}",
+                        socket));
+    }
+    if (received == 0) {
+        throw std::runtime_error(std::format(
+            "Socket {} closed before a descriptor was received", socket));
+    }
+
+    const cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS) {
+        throw std::runtime_error(std::format(
+            "Message on socket {} carried no descriptor", socket));
+    }
+
+    int fd{-1};
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
 }
 
 }  // namespace cpptools
@@ -0,0 +1,110 @@
+#include "cpptools/shared_spinlock_mutex.hpp"
+
+#include <sched.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+// Reader slot of the calling thread. Chosen once from the core the thread
+// first runs a shared lock on, so pinned threads get per-core slots, and kept
+// for the thread's lifetime so unlock_shared() always finds the slot that
+// lock_shared() used, even after migrating.
+size_t reader_slot_index() noexcept {
+    thread_local const size_t t_slot = [] {
+        const int cpu = sched_getcpu();
+        return static_cast<size_t>(cpu < 0 ? 0 : cpu) %
+               shared_spinlock_mutex::READER_SLOTS;
+    }();
+    return t_slot;
+}
+
+}  // namespace
+
+void shared_spinlock_mutex::lock() noexcept {
+    // Claim the writer flag. Once set, no new readers get in.
+    backoff b;
+    while (writer_.exchange(1, std::memory_order_seq_cst) != 0) {
+        while (writer_.load(std::memory_order_relaxed) != 0) {
+            b.pause();
+        }
+    }
+
+    // Wait for readers already inside to leave
+    b.reset();
+    while (!readers_drained()) {
+        b.pause();
+    }
+}
+
+bool shared_spinlock_mutex::try_lock() noexcept {
+    if (writer_.exchange(1, std::memory_order_seq_cst) != 0) {
+        return false;
+    }
+
+    // Back out if any reader is inside
+    if (!readers_drained()) {
+        writer_.store(0, std::memory_order_release);
+        return false;
+    }
+
+    return true;
+}
+
+void shared_spinlock_mutex::unlock() noexcept {
+    writer_.store(0, std::memory_order_release);
+}
+
+void shared_spinlock_mutex::lock_shared() noexcept {
+    std::atomic<uint32_t> &count = readers_[reader_slot_index()].count;
+
+    backoff b;
+    while (true) {
+        // Announce ourselves, then check for a writer. Both sides use seq_cst
+        // so that either the writer sees our count or we see its flag.
+        count.fetch_add(1, std::memory_order_seq_cst);
+        if (writer_.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+
+        // Writer pending or active: step aside and wait for it
+        count.fetch_sub(1, std::memory_order_release);
+        while (writer_.load(std::memory_order_relaxed) != 0) {
+            b.pause();
+        }
+    }
+}
+
+bool shared_spinlock_mutex::try_lock_shared() noexcept {
+    std::atomic<uint32_t> &count = readers_[reader_slot_index()].count;
+
+    count.fetch_add(1, std::memory_order_seq_cst);
+    if (writer_.load(std::memory_order_seq_cst) == 0) {
+        return true;
+    }
+
+    count.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+void shared_spinlock_mutex::unlock_shared() noexcept {
+    readers_[reader_slot_index()].count.fetch_sub(1,
+                                                  std::memory_order_release);
+}
+
+bool shared_spinlock_mutex::readers_drained() const noexcept {
+    for (const reader_slot &slot : readers_) {
+        if (slot.count.load(std::memory_order_seq_cst) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace cpptools
@@ -0,0 +1,202 @@
+#include "cpptools/shm_memory_resource.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+
+namespace cpptools {
+
+namespace {
+
+constexpr uint64_t OFFSET_MASK = 0xffffffff;
+
+constexpr size_t round_up(size_t value, size_t alignment) noexcept {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+shm_memory_resource::shm_memory_resource(std::string_view name, size_t size,
+                                         const shared_memory_options &options)
+    : m_shmem(name, size, options),
+      m_header(static_cast<header *>(m_shmem.data())) {
+    // The heap starts at the first MAX_ALIGNMENT boundary after the header.
+    // Mappings are page aligned, so this is the same offset in every process.
+    const auto data = reinterpret_cast<uintptr_t>(m_shmem.data());
+    const uintptr_t heap = round_up(data + sizeof(header), MAX_ALIGNMENT);
+    if (heap >= data + size) {
+        throw std::length_error(
+            std::format("Shared memory resource \"{}\" of {} bytes is too "
+                        "small: it needs more than {} bytes",
+                        name, size, heap - data));
+    }
+    if (data + size - heap > MAX_HEAP_SIZE) {
+        throw std::length_error(
+            std::format("Shared memory resource \"{}\" of {} bytes is too "
+                        "large: the heap can be at most {} bytes",
+                        name, size, MAX_HEAP_SIZE));
+    }
+
+    m_heap = reinterpret_cast<std::byte *>(heap);
+    m_capacity = data + size - heap;
+}
+
+size_t shm_memory_resource::size_class(size_t bytes) noexcept {
+    if (bytes <= SMALL_CLASSES * MIN_ALIGNMENT) {
+        return bytes == 0 ? 0 : (bytes - 1) / MIN_ALIGNMENT;
+    }
+
+    // bytes is in (2^p, 2^(p+1)], split into four steps of 2^(p-2)
+    const size_t p = std::bit_width(bytes - 1) - 1;
+    const size_t step = size_t{1} << (p - 2);
+    const size_t sub = (bytes - 1 - (size_t{1} << p)) / step;
+    return SMALL_CLASSES + (p - 7) * 4 + sub;
+}
+
+size_t shm_memory_resource::class_size(size_t index) noexcept {
+    if (index < SMALL_CLASSES) {
+        return (index + 1) * MIN_ALIGNMENT;
+    }
+
+    const size_t p = 7 + (index - SMALL_CLASSES) / 4;
+    const size_t sub = (index - SMALL_CLASSES) % 4;
+    return (size_t{1} << p) + (sub + 1) * (size_t{1} << (p - 2));
+}
+
+size_t shm_memory_resource::block_size(size_t bytes,
+                                       size_t alignment) noexcept {
+    if (alignment > MAX_ALIGNMENT || bytes > MAX_HEAP_SIZE) {
+        return 0;
+    }
+    if (alignment > MIN_ALIGNMENT) {
+        // Power-of-two classes are aligned to their size
+        bytes = std::max(std::bit_ceil(bytes), alignment);
+    }
+    return class_size(size_class(bytes));
+}
+
+void *shm_memory_resource::do_allocate(size_t bytes, size_t alignment) {
+    const size_t size = block_size(bytes, alignment);
+    if (size == 0) {
+        m_header->failed.fetch_add(1, std::memory_order_relaxed);
+        throw std::bad_alloc();
+    }
+
+    free_list &list = m_header->classes[size_class(size)];
+    size_t offset{0};
+    if (!pop(list, offset) &&
+        !carve(size, std::has_single_bit(size) ? size : MIN_ALIGNMENT,
+               offset)) {
+        m_header->failed.fetch_add(1, std::memory_order_relaxed);
+        throw std::bad_alloc();
+    }
+
+    list.blocks.fetch_add(1, std::memory_order_relaxed);
+    list.requested.fetch_add(bytes, std::memory_order_relaxed);
+    return m_heap + offset;
+}
+
+void shm_memory_resource::do_deallocate(void *p, size_t bytes,
+                                        size_t alignment) {
+    if (p == nullptr) {
+        return;
+    }
+
+    free_list &list =
+        m_header->classes[size_class(block_size(bytes, alignment))];
+    list.blocks.fetch_sub(1, std::memory_order_relaxed);
+    list.requested.fetch_sub(bytes, std::memory_order_relaxed);
+    push(list, offset_of(p));
+}
+
+bool shm_memory_resource::do_is_equal(
+    const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+std::atomic_ref<uint32_t> shm_memory_resource::next_of(
+    size_t offset) const noexcept {
+    return std::atomic_ref<uint32_t>(
+        *reinterpret_cast<uint32_t *>(m_heap + offset));
+}
+
+void shm_memory_resource::push(free_list &list, size_t offset) noexcept {
+    const uint64_t link = offset / MIN_ALIGNMENT + 1;
+    uint64_t head = list.head.load(std::memory_order_relaxed);
+    uint64_t next{0};
+    do {
+        next_of(offset).store(head & OFFSET_MASK, std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | link;
+    } while (!list.head.compare_exchange_weak(head, next,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+}
+
+bool shm_memory_resource::pop(free_list &list, size_t &offset) noexcept {
+    uint64_t head = list.head.load(std::memory_order_acquire);
+    while ((head & OFFSET_MASK) != 0) {
+        // The block may be popped and reused by someone else before our CAS,
+        // in which case the tag has moved on and the CAS fails
+        const size_t candidate = ((head & OFFSET_MASK) - 1) * MIN_ALIGNMENT;
+        const uint64_t link =
+            next_of(candidate).load(std::memory_order_relaxed);
+        const uint64_t next = (((head >> 32) + 1) << 32) | link;
+        if (list.head.compare_exchange_weak(head, next,
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+            offset = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool shm_memory_resource::carve(size_t size, size_t alignment,
+                                size_t &offset) noexcept {
+    alignment = std::min(alignment, MAX_ALIGNMENT);
+
+    uint64_t bump = m_header->bump.load(std::memory_order_relaxed);
+    size_t start{0};
+    do {
+        start = round_up(bump, alignment);
+        if (start > m_capacity || size > m_capacity - start) {
+            return false;
+        }
+    } while (!m_header->bump.compare_exchange_weak(
+        bump, start + size, std::memory_order_relaxed));
+
+    if (start != bump) {
+        m_header->padding.fetch_add(start - bump, std::memory_order_relaxed);
+    }
+    offset = start;
+    return true;
+}
+
+shm_memory_stats shm_memory_resource::stats() const noexcept {
+    shm_memory_stats stats;
+    stats.capacity = m_capacity;
+    stats.reserved = m_header->bump.load(std::memory_order_relaxed);
+    stats.padding = m_header->padding.load(std::memory_order_relaxed);
+    stats.failed = m_header->failed.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < NUM_CLASSES; ++i) {
+        const free_list &list = m_header->classes[i];
+        const size_t blocks = list.blocks.load(std::memory_order_relaxed);
+        stats.blocks += blocks;
+        stats.in_use += blocks * class_size(i);
+        stats.requested += list.requested.load(std::memory_order_relaxed);
+    }
+
+    const size_t used = stats.in_use + stats.padding;
+    stats.cached = stats.reserved > used ? stats.reserved - used : 0;
+    return stats;
+}
+
+}  // namespace cpptools
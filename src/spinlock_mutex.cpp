@@ -2,12 +2,25 @@
 
 #include <atomic>
 
+#include "cpptools/backoff.hpp"
+
 namespace cpptools {
 
 void spinlock_mutex::lock() {
-    // Tries to set flag until test_and_set() returns false, i.e. the mutex was
-    // unlocked and we acquired it.
-    while (flag_.test_and_set(std::memory_order_acquire));
+    // Fast path: a single test_and_set() when the mutex is uncontended.
+    if (!flag_.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Slow path: wait with read-only loads so that waiters share the cache
+    // line instead of bouncing it between cores with RMW ops, and back off
+    // between polls. Only retry test_and_set() once the flag looks clear.
+    backoff b(limits_);
+    do {
+        while (flag_.test(std::memory_order_relaxed)) {
+            b.pause();
+        }
+    } while (flag_.test_and_set(std::memory_order_acquire));
 }
 
 bool spinlock_mutex::try_lock() noexcept {
@@ -23,4 +36,4 @@ void spinlock_mutex::unlock() noexcept {
     flag_.clear(std::memory_order_release);
 }
 
-}  // namespace cpptools
\ No newline at end of file
+}  // namespace cpptools
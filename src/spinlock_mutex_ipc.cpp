@@ -0,0 +1,131 @@
+#include "cpptools/spinlock_mutex_ipc.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "IPC lock word must be lock-free");
+
+// Calling thread's id, cached so the fast path stays a single atomic op. A
+// forked child inherits the parent's cache, so it's cleared on fork.
+thread_local uint32_t t_tid{0};
+
+uint32_t self_tid() noexcept {
+    [[maybe_unused]] static const int registered =
+        pthread_atfork(nullptr, nullptr, [] { t_tid = 0; });
+    if (t_tid == 0) {
+        t_tid = static_cast<uint32_t>(gettid());
+    }
+    return t_tid;
+}
+
+// Whether the thread exists and hasn't exited. An exited thread whose
+// process hasn't been reaped yet still answers kill(), so zombies are
+// filtered out through /proc. If /proc isn't available, assume it's alive.
+bool thread_alive(uint32_t tid) noexcept {
+    if (kill(static_cast<pid_t>(tid), 0) == -1 && errno == ESRCH) {
+        return false;
+    }
+
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%u/stat", tid);
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return errno != ENOENT || access("/proc/self", F_OK) != 0;
+    }
+    char stat[512];
+    const ssize_t len = read(fd, stat, sizeof(stat));
+    close(fd);
+    if (len <= 0) {
+        return len == -1 && errno != ESRCH;
+    }
+
+    // State is the field after "(comm)", and comm may contain parentheses
+    const std::string_view view(stat, static_cast<size_t>(len));
+    const size_t paren = view.rfind(')');
+    if (paren == std::string_view::npos || paren + 2 >= view.size()) {
+        return true;
+    }
+    const char state = view[paren + 2];
+    return state != 'Z' && state != 'X';
+}
+
+}  // namespace
+
+spinlock_mutex_ipc::spinlock_mutex_ipc(std::string_view name)
+    : m_shmem(name, sizeof(std::atomic<uint32_t>)),
+      m_owner(m_shmem.as_struct<std::atomic<uint32_t>>()) {}
+
+lock_status spinlock_mutex_ipc::lock() noexcept {
+    // Fast path: a single CAS when the mutex is uncontended.
+    const uint32_t self = self_tid();
+    uint32_t expected = 0;
+    if (m_owner->compare_exchange_strong(expected, self,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+        return lock_status::acquired;
+    }
+    return lock_slow(self);
+}
+
+lock_status spinlock_mutex_ipc::lock_slow(uint32_t self) noexcept {
+    // Poll with plain loads. Every POLLS_BEFORE_CHECK polls, check that the
+    // owner is still around, and yield in case it's waiting for our core.
+    uint32_t polls{0};
+    for (;;) {
+        uint32_t owner = m_owner->load(std::memory_order_relaxed);
+        if (owner == 0) {
+            if (m_owner->compare_exchange_weak(owner, self,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+                return lock_status::acquired;
+            }
+            continue;
+        }
+
+        if (++polls < POLLS_BEFORE_CHECK) {
+            cpu_relax();
+            continue;
+        }
+        polls = 0;
+
+        // Take over from a dead owner. If several waiters notice at once,
+        // the CAS lets exactly one of them recover the lock.
+        if (!thread_alive(owner) &&
+            m_owner->compare_exchange_strong(owner, self,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            return lock_status::owner_dead;
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool spinlock_mutex_ipc::try_lock() noexcept {
+    uint32_t expected = 0;
+    return m_owner->compare_exchange_strong(expected, self_tid(),
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed);
+}
+
+void spinlock_mutex_ipc::unlock() noexcept {
+    m_owner->store(0, std::memory_order_release);
+}
+
+}  // namespace cpptools
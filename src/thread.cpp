@@ -5,20 +5,250 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cerrno>
+#include <exception>
+#include <format>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "cpptools/numa.hpp"
+
 namespace cpptools {
 
-thread::thread(thread&& other) noexcept : core_(other.core_) {
-    other.core_ = -1;
+namespace {
+
+// Destroys a pthread_attr_t on scope exit
+struct attr_guard {
+    pthread_attr_t& attr;
+    ~attr_guard() { pthread_attr_destroy(&attr); }
+};
+
+void throw_if_error(int err, const char* what) {
+    if (err != 0) {
+        throw std::system_error(err, std::system_category(), what);
+    }
+}
+
+// Binds the calling thread's stack to node, moving pages already touched
+// (e.g. by the creating thread, or on a reused stack) there too
+bool bind_own_stack(int node) noexcept {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return false;
+    }
+
+    void* addr{nullptr};
+    size_t size{0};
+    const int ret = pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return false;
+    }
 
-    this->name_.swap(other.name_);
-    this->swap(other);
+    return numa::bind_memory(addr, size, numa_policy::bind, {&node, 1},
+                             true) == 0;
+}
+
+}  // namespace
+
+// Handed to the new thread, which takes ownership
+struct thread::launch {
+    std::unique_ptr<routine> fn;
+    std::string name;
+    int stack_node{-1};
+    std::optional<latency_profile> latency;
+
+    // Set if the creator waits for the thread to report back
+    thread* self{nullptr};
+    std::atomic<bool>* ready{nullptr};
+};
+
+void* thread::trampoline(void* arg) {
+    std::unique_ptr<launch> l(static_cast<launch*>(arg));
+
+    if (!l->name.empty()) {
+        pthread_setname_np(pthread_self(), l->name.c_str());
+    }
+
+    int stack_node{-1};
+    if (l->stack_node >= 0 && bind_own_stack(l->stack_node)) {
+        stack_node = l->stack_node;
+    }
+
+    bool run{true};
+    latency_report report;
+    if (l->latency) {
+        report = apply_latency_profile(*l->latency);
+        run = !l->latency->strict || report.ok();
+    }
+
+    // The creator is blocked in start() until ready is set, so writing to
+    // its thread object is safe until then
+    if (l->ready != nullptr) {
+        l->self->stack_node_ = stack_node;
+        l->self->latency_ = std::move(report);
+        l->ready->store(true, std::memory_order_release);
+        l->ready->notify_one();
+    }
+
+    std::unique_ptr<routine> fn = std::move(l->fn);
+    l.reset();
+    if (run) {
+        fn->run();
+    }
+    return nullptr;
+}
+
+void thread::start(const thread_attributes& attributes,
+                   std::unique_ptr<routine> fn) {
+    if (attributes.name.length() > MAX_NAME_LEN) {
+        throw std::length_error(
+            std::format("Thread name \"{}\" of length {} is invalid: length "
+                        "must be at most {}",
+                        attributes.name, attributes.name.length(),
+                        MAX_NAME_LEN));
+    }
+
+    pthread_attr_t attr;
+    throw_if_error(pthread_attr_init(&attr), "pthread_attr_init");
+    attr_guard guard{attr};
+
+    if (attributes.stack_size > 0) {
+        throw_if_error(
+            pthread_attr_setstacksize(&attr, attributes.stack_size),
+            "Invalid thread stack size");
+    }
+    if (attributes.guard_size) {
+        throw_if_error(
+            pthread_attr_setguardsize(&attr, *attributes.guard_size),
+            "Invalid thread guard size");
+    }
+
+    if (!attributes.cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (const int cpu : attributes.cpus) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                throw_if_error(EINVAL, "Invalid thread CPU");
+            }
+            CPU_SET(cpu, &cpuset);
+        }
+        throw_if_error(
+            pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset),
+            "Invalid thread CPU set");
+    }
+
+    auto l = std::make_unique<launch>();
+    l->fn = std::move(fn);
+    l->name = attributes.name;
+    l->latency = attributes.latency;
+
+    // Stack node: as given, or the node shared by all target CPUs on
+    // multi-node machines
+    l->stack_node = attributes.stack_node;
+    if (l->stack_node < 0 && !attributes.cpus.empty() &&
+        numa::online_nodes().size() > 1) {
+        const int node = numa::node_of_cpu(attributes.cpus.front());
+        bool same_node{true};
+        for (const int cpu : attributes.cpus) {
+            same_node = same_node && numa::node_of_cpu(cpu) == node;
+        }
+        l->stack_node = same_node ? node : -1;
+    }
+
+    // Wait for the thread to report back only if it has something to report
+    std::atomic<bool> ready{false};
+    const bool handshake = l->stack_node >= 0 || l->latency.has_value();
+    if (handshake) {
+        l->self = this;
+        l->ready = &ready;
+    }
+
+    throw_if_error(pthread_create(&handle_, &attr, trampoline, l.get()),
+                   "Can't create thread");
+    l.release();
+
+    joinable_ = true;
+    name_ = attributes.name;
+    core_ = attributes.cpus.size() == 1 ? attributes.cpus.front() : -1;
+
+    if (!handshake) {
+        return;
+    }
+    ready.wait(false, std::memory_order_acquire);
+
+    if (attributes.latency && attributes.latency->strict && !latency_.ok()) {
+        join();
+
+        std::string what = "Latency profile failed: ";
+        for (size_t i = 0; i < latency_.errors.size(); ++i) {
+            what += (i == 0 ? "" : "; ") + latency_.errors[i];
+        }
+        throw std::runtime_error(what);
+    }
+}
+
+thread::~thread() {
+    if (joinable_) {
+        std::terminate();
+    }
+}
+
+thread::thread(thread&& other) noexcept { swap(other); }
+
+thread& thread::operator=(thread&& other) noexcept {
+    if (joinable_) {
+        std::terminate();
+    }
+
+    thread tmp(std::move(other));
+    swap(tmp);
+    return *this;
+}
+
+void thread::swap(thread& other) noexcept {
+    std::swap(handle_, other.handle_);
+    std::swap(joinable_, other.joinable_);
+    name_.swap(other.name_);
+    std::swap(core_, other.core_);
+    std::swap(stack_node_, other.stack_node_);
+    std::swap(latency_, other.latency_);
+}
+
+std::thread::id thread::get_id() const noexcept {
+    // libstdc++'s std::thread::id wraps the pthread_t
+    return joinable_ ? std::thread::id(handle_) : std::thread::id();
+}
+
+void thread::join() {
+    if (!joinable_) {
+        throw_if_error(EINVAL, "Thread is not joinable");
+    }
+    throw_if_error(pthread_join(handle_, nullptr), "Can't join thread");
+    joinable_ = false;
+}
+
+void thread::detach() {
+    if (!joinable_) {
+        throw_if_error(EINVAL, "Thread is not joinable");
+    }
+    throw_if_error(pthread_detach(handle_), "Can't detach thread");
+    joinable_ = false;
 }
 
 bool thread::set_name(const std::string_view& name) noexcept {
     if (name.length() <= MAX_NAME_LEN) {
-        const int ret = pthread_setname_np(pthread_self(), name_.c_str());
+        std::string new_name(name);
+        const pthread_t target = joinable_ ? handle_ : pthread_self();
+        const int ret = pthread_setname_np(target, new_name.c_str());
         if (ret == 0) {
-            name_ = name;
+            name_ = std::move(new_name);
             return true;
         }
     }
@@ -27,12 +257,16 @@ bool thread::set_name(const std::string_view& name) noexcept {
 }
 
 bool thread::set_core(int core) noexcept {
+    if (core < 0 || core >= CPU_SETSIZE) {
+        return false;
+    }
+
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
     CPU_SET(core, &cpuset);
 
-    const int ret =
-        pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    const pthread_t target = joinable_ ? handle_ : pthread_self();
+    const int ret = pthread_setaffinity_np(target, sizeof(cpuset), &cpuset);
     if (ret == 0) {
         core_ = core;
         return true;
@@ -0,0 +1,280 @@
+#include "cpptools/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+// Worker the calling thread is, if any
+thread_local const thread_pool *t_pool{nullptr};
+thread_local size_t t_index{0};
+
+// Victim selection for threads that aren't workers
+thread_local uint64_t t_rng{0};
+
+uint64_t xorshift(uint64_t &state) noexcept {
+    if (state == 0) {
+        state = reinterpret_cast<uintptr_t>(&state) | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+}  // namespace
+
+thread_pool::thread_pool(const thread_pool_options &options)
+    : m_spins_before_park(options.spins_before_park) {
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = options.cores.empty()
+                      ? std::max(1u, std::thread::hardware_concurrency())
+                      : options.cores.size();
+    }
+
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.push_back(std::make_unique<worker>());
+        m_workers.back()->rng = i + 1;
+    }
+
+    // Workers are named and pinned before they run
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            thread_attributes attributes;
+            attributes.name = std::format("{}-{}", options.name, i);
+            attributes.name.resize(
+                std::min(attributes.name.size(), thread::MAX_NAME_LEN));
+            if (!options.cores.empty()) {
+                attributes.cpus = {options.cores[i % options.cores.size()]};
+            }
+
+            m_workers[i]->thread =
+                cpptools::thread(attributes, [this, i] { run_worker(i); });
+        }
+    } catch (...) {
+        // Destroying a joinable thread terminates, so stop the workers that
+        // did start before giving up
+        stop_workers();
+        throw;
+    }
+}
+
+thread_pool::~thread_pool() {
+    wait();
+    stop_workers();
+}
+
+void thread_pool::stop_workers() {
+    m_stopping.store(true, std::memory_order_seq_cst);
+    m_signal.fetch_add(1, std::memory_order_seq_cst);
+    m_signal.notify_all();
+
+    for (auto &w : m_workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+}
+
+void thread_pool::run_worker(size_t index) {
+    t_pool = this;
+    t_index = index;
+
+    uint32_t idle{0};
+    while (true) {
+        if (task *t = find_task()) {
+            run(t);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < m_spins_before_park) {
+            cpu_relax();
+            continue;
+        }
+
+        if (m_stopping.load(std::memory_order_acquire) && !has_work()) {
+            break;
+        }
+        park();
+        idle = 0;
+    }
+
+    t_pool = nullptr;
+}
+
+void thread_pool::push(task *t) {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (t_pool == this) {
+        m_workers[t_index]->deque.push(t);
+    } else {
+        std::scoped_lock l(m_injection_lock);
+        m_injection.push_back(t);
+        m_injected.fetch_add(1, std::memory_order_release);
+    }
+
+    wake(1);
+}
+
+void thread_pool::push(const std::vector<task *> &tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    m_pending.fetch_add(tasks.size(), std::memory_order_relaxed);
+
+    if (t_pool == this) {
+        for (task *t : tasks) {
+            m_workers[t_index]->deque.push(t);
+        }
+    } else {
+        std::scoped_lock l(m_injection_lock);
+        m_injection.insert(m_injection.end(), tasks.begin(), tasks.end());
+        m_injected.fetch_add(tasks.size(), std::memory_order_release);
+    }
+
+    wake(tasks.size());
+}
+
+void thread_pool::wake(size_t count) noexcept {
+    // Pairs with park(): either we see the parked worker, or it sees the new
+    // task when it re-checks for work
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    m_signal.fetch_add(1, std::memory_order_seq_cst);
+    if (count == 1) {
+        m_signal.notify_one();
+    } else {
+        m_signal.notify_all();
+    }
+}
+
+void thread_pool::park() {
+    m_parked.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const uint32_t signal = m_signal.load(std::memory_order_seq_cst);
+
+    // Re-check after announcing ourselves, so a submitter that missed us has
+    // published its task where we can see it
+    if (!has_work() && !m_stopping.load(std::memory_order_seq_cst)) {
+        m_signal.wait(signal, std::memory_order_seq_cst);
+    }
+
+    m_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void thread_pool::run(task *t) noexcept {
+    (*t)();
+    delete t;
+    m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+thread_pool::task *thread_pool::find_task() noexcept {
+    const bool is_worker = (t_pool == this);
+    if (is_worker) {
+        if (auto t = m_workers[t_index]->deque.take()) {
+            return *t;
+        }
+    }
+
+    if (task *t = pop_injected()) {
+        return t;
+    }
+
+    return is_worker ? steal(m_workers[t_index]->rng, t_index)
+                     : steal(t_rng, m_workers.size());
+}
+
+thread_pool::task *thread_pool::pop_injected() noexcept {
+    if (m_injected.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+
+    std::scoped_lock l(m_injection_lock);
+    if (m_injection.empty()) {
+        return nullptr;
+    }
+    task *t = m_injection.front();
+    m_injection.pop_front();
+    m_injected.fetch_sub(1, std::memory_order_relaxed);
+    return t;
+}
+
+thread_pool::task *thread_pool::steal(uint64_t &rng, size_t self) noexcept {
+    // One pass over the other workers from a random start
+    const size_t n = m_workers.size();
+    const size_t start = xorshift(rng) % n;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t victim = (start + i) % n;
+        if (victim == self) {
+            continue;
+        }
+        if (auto t = m_workers[victim]->deque.steal()) {
+            return *t;
+        }
+    }
+    return nullptr;
+}
+
+bool thread_pool::has_work() const noexcept {
+    if (m_injected.load(std::memory_order_seq_cst) != 0) {
+        return true;
+    }
+    return std::any_of(m_workers.begin(), m_workers.end(),
+                       [](const auto &w) { return !w->deque.empty(); });
+}
+
+void thread_pool::run_range(range_job &job, size_t begin, size_t end) {
+    while (begin < end) {
+        // Split off the upper half while nobody has anything to steal
+        if (end - begin > job.grain && local_backlog() == 0) {
+            const size_t mid = begin + (end - begin) / 2;
+            job.pending.fetch_add(1, std::memory_order_relaxed);
+            push(new task([this, &job, mid, end] {
+                run_range(job, mid, end);
+                job.pending.fetch_sub(1, std::memory_order_release);
+            }));
+            end = mid;
+            continue;
+        }
+
+        const size_t chunk_end = std::min(end, begin + job.grain);
+        job.body(begin, chunk_end);
+        begin = chunk_end;
+    }
+}
+
+size_t thread_pool::local_backlog() const noexcept {
+    if (t_pool == this) {
+        return m_workers[t_index]->deque.size();
+    }
+    return m_injected.load(std::memory_order_relaxed);
+}
+
+void thread_pool::wait(const std::atomic<size_t> &pending) {
+    while (pending.load(std::memory_order_acquire) != 0) {
+        if (task *t = find_task()) {
+            run(t);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}  // namespace cpptools
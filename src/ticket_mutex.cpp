@@ -0,0 +1,59 @@
+#include "cpptools/ticket_mutex.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "cpptools/backoff.hpp"
+
+namespace cpptools {
+
+namespace {
+
+// Polls before yielding the CPU. Tickets are served in order, so a preempted
+// waiter stalls everyone behind it unless the spinners get out of its way.
+constexpr uint32_t POLLS_BEFORE_YIELD = 1 << 10;
+
+}  // namespace
+
+void ticket_mutex::lock() noexcept {
+    // Take a ticket and wait for it to be served.
+    const uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t polls{0};
+    uint32_t serving = serving_.load(std::memory_order_acquire);
+    while (serving != ticket) {
+        if (++polls >= POLLS_BEFORE_YIELD) {
+            std::this_thread::yield();
+        }
+
+        // Proportional backoff: the further back in the queue we are, the
+        // longer we can wait before polling again. Unsigned subtraction
+        // handles wrap-around.
+        const uint32_t ahead = ticket - serving;
+        for (uint32_t i = 0; i < ahead; ++i) {
+            cpu_relax();
+        }
+
+        serving = serving_.load(std::memory_order_acquire);
+    }
+}
+
+bool ticket_mutex::try_lock() noexcept {
+    // The mutex is free only if the next ticket would be served immediately,
+    // so take a ticket only in that case. unlock() publishes through
+    // serving_ alone, so that load must acquire, as in lock().
+    const uint32_t serving = serving_.load(std::memory_order_acquire);
+    uint32_t expected = serving;
+    return next_.compare_exchange_strong(expected, serving + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+}
+
+void ticket_mutex::unlock() noexcept {
+    // Only the owner writes serving_, so no RMW is needed.
+    const uint32_t serving = serving_.load(std::memory_order_relaxed);
+    serving_.store(serving + 1, std::memory_order_release);
+}
+
+}  // namespace cpptools
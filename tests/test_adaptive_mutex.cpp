@@ -0,0 +1,103 @@
+#include "cpptools/adaptive_mutex.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using cpptools::adaptive_mutex;
+
+TEST(adaptive_mutex, constructor) {
+    ASSERT_NO_FATAL_FAILURE(adaptive_mutex{});
+
+    // Zero budget, as found in fresh shared memory, selects the default
+    adaptive_mutex m1;
+    EXPECT_EQ(m1.spin_budget(), adaptive_mutex::DEFAULT_SPIN_BUDGET);
+    adaptive_mutex m2(0);
+    EXPECT_EQ(m2.spin_budget(), adaptive_mutex::DEFAULT_SPIN_BUDGET);
+    adaptive_mutex m3(16);
+    EXPECT_EQ(m3.spin_budget(), 16u);
+}
+
+TEST(adaptive_mutex, try_lock) {
+    adaptive_mutex m;
+
+    // Lock once - can't lock again
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+
+    // Unlock - CAN lock again
+    m.unlock();
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(adaptive_mutex, lock_unlock) {
+    adaptive_mutex m;
+
+    m.lock();
+    EXPECT_FALSE(m.try_lock());
+    m.unlock();
+
+    // Works with std::scoped_lock
+    {
+        std::scoped_lock l(m);
+        EXPECT_FALSE(m.try_lock());
+    }
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(adaptive_mutex, parked_waiter_woken) {
+    adaptive_mutex m(1);
+    m.lock();
+
+    // Waiter exhausts its budget and parks while we hold the mutex
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&] {
+        std::scoped_lock l(m);
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired);
+
+    // Unlock must wake it
+    m.unlock();
+    waiter.join();
+    EXPECT_TRUE(acquired);
+
+    // And leave the mutex unlocked
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(adaptive_mutex, contended) {
+    // More threads than cores, with a small budget so that waiters park
+    for (const uint32_t budget : {1u, 0u}) {
+        adaptive_mutex m(budget);
+
+        const int num_threads =
+            4 * std::max(1u, std::thread::hardware_concurrency());
+        constexpr int num_iters = 10000;
+        int counter{0};
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < num_iters; ++j) {
+                    std::scoped_lock l(m);
+                    ++counter;
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        EXPECT_EQ(counter, num_threads * num_iters);
+    }
+}
@@ -0,0 +1,49 @@
+#include "cpptools/backoff.hpp"
+
+#include <gtest/gtest.h>
+
+using cpptools::backoff;
+using cpptools::backoff_limits;
+
+TEST(backoff, exponential_growth) {
+    backoff b({.min_spins = 2, .max_spins = 16});
+    EXPECT_EQ(b.spins(), 2u);
+
+    // Doubles on each pause
+    b.pause();
+    EXPECT_EQ(b.spins(), 4u);
+    b.pause();
+    EXPECT_EQ(b.spins(), 8u);
+    b.pause();
+    EXPECT_EQ(b.spins(), 16u);
+
+    // Bounded by max
+    b.pause();
+    EXPECT_EQ(b.spins(), 16u);
+
+    // Reset to min
+    b.reset();
+    EXPECT_EQ(b.spins(), 2u);
+}
+
+TEST(backoff, zero_limits_use_defaults) {
+    // Zero-initialized limits, as found in fresh shared memory
+    backoff b({.min_spins = 0, .max_spins = 0});
+    EXPECT_EQ(b.spins(), backoff_limits::DEFAULT_MIN_SPINS);
+}
+
+TEST(backoff, max_below_min) {
+    // Max is raised to min
+    backoff b({.min_spins = 8, .max_spins = 2});
+    b.pause();
+    EXPECT_EQ(b.spins(), 8u);
+}
+
+TEST(backoff, pause_or_yield) {
+    // Grows like pause, and keeps going once at max
+    backoff b({.min_spins = 2, .max_spins = 4});
+    b.pause_or_yield();
+    EXPECT_EQ(b.spins(), 4u);
+    b.pause_or_yield();
+    EXPECT_EQ(b.spins(), 4u);
+}
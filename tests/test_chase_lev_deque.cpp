@@ -0,0 +1,97 @@
+#include "cpptools/chase_lev_deque.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using cpptools::chase_lev_deque;
+
+TEST(chase_lev_deque, constructor) {
+    chase_lev_deque<int> d;
+    EXPECT_TRUE(d.empty());
+    EXPECT_EQ(d.capacity(), chase_lev_deque<int>::DEFAULT_CAPACITY);
+
+    // Rounded up to a power of 2
+    chase_lev_deque<int> d2(100);
+    EXPECT_EQ(d2.capacity(), 128u);
+}
+
+TEST(chase_lev_deque, take_lifo_steal_fifo) {
+    chase_lev_deque<int> d;
+    for (int i = 0; i < 4; ++i) {
+        d.push(i);
+    }
+    EXPECT_EQ(d.size(), 4u);
+
+    // Owner takes the newest, thieves the oldest
+    EXPECT_EQ(d.take(), 3);
+    EXPECT_EQ(d.steal(), 0);
+    EXPECT_EQ(d.take(), 2);
+    EXPECT_EQ(d.steal(), 1);
+
+    EXPECT_TRUE(d.empty());
+    EXPECT_EQ(d.take(), std::nullopt);
+    EXPECT_EQ(d.steal(), std::nullopt);
+}
+
+TEST(chase_lev_deque, grow) {
+    chase_lev_deque<int> d(4);
+
+    // Growing keeps every item, in order
+    for (int i = 0; i < 100; ++i) {
+        d.push(i);
+    }
+    EXPECT_GE(d.capacity(), 100u);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(d.steal(), i);
+    }
+    for (int i = 99; i >= 50; --i) {
+        EXPECT_EQ(d.take(), i);
+    }
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(chase_lev_deque, concurrent_steal) {
+    constexpr int num_items = 100000;
+    constexpr int num_thieves = 3;
+
+    chase_lev_deque<int> d(16);
+    std::vector<std::atomic<int>> seen(num_items);
+    std::atomic<bool> done{false};
+
+    // Thieves steal until the owner is done and the deque is drained
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < num_thieves; ++i) {
+        thieves.emplace_back([&] {
+            while (!done || !d.empty()) {
+                if (auto item = d.steal()) {
+                    ++seen[*item];
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Owner pushes everything, taking some back along the way
+    for (int i = 0; i < num_items; ++i) {
+        d.push(i);
+        if (i % 3 == 0) {
+            if (auto item = d.take()) {
+                ++seen[*item];
+            }
+        }
+    }
+    done = true;
+    for (auto &t : thieves) {
+        t.join();
+    }
+
+    // Every item taken exactly once
+    for (int i = 0; i < num_items; ++i) {
+        ASSERT_EQ(seen[i], 1) << "item " << i;
+    }
+}
@@ -0,0 +1,173 @@
+#include "cpptools/cpu_topology.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using cpptools::cpu_topology;
+using cpptools::placement_request;
+
+namespace fs = std::filesystem;
+
+// Fake sysfs/procfs tree: 2 sockets x 2 cores x 2 hardware threads, one NUMA
+// node and L3 per socket, one L2 per core. CPUs n and n + 4 are siblings.
+// CPUs 2, 3, 6 and 7 are isolated, and the process may use 1-7.
+class fake_topology : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_root = fs::temp_directory_path() /
+                 std::format("cpptools_topology_{}", getpid());
+        fs::remove_all(m_root);
+
+        const std::string cpu_dir = "/sys/devices/system/cpu";
+        write(cpu_dir + "/online", "0-7");
+        write(cpu_dir + "/isolated", "");
+        write("/proc/cmdline", "ro quiet isolcpus=domain,2-3,6-7");
+        write("/proc/self/status",
+              "Name:\ttest\nCpus_allowed:\tfe\nCpus_allowed_list:\t1-7\n");
+
+        for (int cpu = 0; cpu < 8; ++cpu) {
+            const int core = cpu % 4;
+            const int socket = core / 2;
+            const std::string dir = std::format("{}/cpu{}", cpu_dir, cpu);
+            write(dir + "/topology/physical_package_id",
+                  std::to_string(socket));
+            write(dir + "/topology/core_id", std::to_string(core % 2));
+            write(dir + "/topology/thread_siblings_list",
+                  std::format("{},{}", core, core + 4));
+            fs::create_directories(m_root.string() + dir +
+                                   std::format("/node{}", socket));
+
+            write(dir + "/cache/index0/level", "1");
+            write(dir + "/cache/index0/type", "Data");
+            write(dir + "/cache/index0/shared_cpu_list",
+                  std::format("{},{}", core, core + 4));
+            write(dir + "/cache/index1/level", "1");
+            write(dir + "/cache/index1/type", "Instruction");
+            write(dir + "/cache/index1/shared_cpu_list",
+                  std::format("{},{}", core, core + 4));
+            write(dir + "/cache/index2/level", "2");
+            write(dir + "/cache/index2/type", "Unified");
+            write(dir + "/cache/index2/shared_cpu_list",
+                  std::format("{},{}", core, core + 4));
+            write(dir + "/cache/index3/level", "3");
+            write(dir + "/cache/index3/type", "Unified");
+            write(dir + "/cache/index3/shared_cpu_list",
+                  socket == 0 ? "0-1,4-5" : "2-3,6-7");
+        }
+    }
+
+    void TearDown() override { fs::remove_all(m_root); }
+
+    void write(const std::string &path, const std::string &contents) {
+        const fs::path file = m_root.string() + path;
+        fs::create_directories(file.parent_path());
+        std::ofstream(file) << contents << '\n';
+    }
+
+    fs::path m_root;
+};
+
+TEST_F(fake_topology, cpus) {
+    cpu_topology topo(m_root.string());
+    ASSERT_EQ(topo.cpus().size(), 8u);
+
+    const cpptools::cpu_info *cpu5 = topo.cpu(5);
+    ASSERT_NE(cpu5, nullptr);
+    EXPECT_EQ(cpu5->id, 5);
+    EXPECT_EQ(cpu5->socket, 0);
+    EXPECT_EQ(cpu5->core, 1);
+    EXPECT_EQ(cpu5->node, 0);
+    EXPECT_EQ(cpu5->smt_siblings, std::vector<int>({1, 5}));
+    EXPECT_EQ(cpu5->l2_domain, 1);
+    EXPECT_EQ(cpu5->l3_domain, 0);
+
+    EXPECT_EQ(topo.cpu(8), nullptr);
+    EXPECT_EQ(topo.cpu(-1), nullptr);
+}
+
+TEST_F(fake_topology, groupings) {
+    cpu_topology topo(m_root.string());
+    EXPECT_EQ(topo.sockets(), std::vector<int>({0, 1}));
+    EXPECT_EQ(topo.nodes(), std::vector<int>({0, 1}));
+    EXPECT_EQ(topo.cpus_on_socket(1), std::vector<int>({2, 3, 6, 7}));
+    EXPECT_EQ(topo.cpus_on_node(0), std::vector<int>({0, 1, 4, 5}));
+    EXPECT_EQ(topo.physical_cores(), std::vector<int>({0, 1, 2, 3}));
+    EXPECT_EQ(topo.sharing_cache(6, 2), std::vector<int>({2, 6}));
+    EXPECT_EQ(topo.sharing_cache(6, 3), std::vector<int>({2, 3, 6, 7}));
+    EXPECT_TRUE(topo.sharing_cache(42, 3).empty());
+}
+
+TEST_F(fake_topology, cpu_sets) {
+    cpu_topology topo(m_root.string());
+
+    // Empty sysfs list falls back to the kernel command line
+    EXPECT_EQ(topo.isolated(), std::vector<int>({2, 3, 6, 7}));
+    EXPECT_TRUE(topo.nohz_full().empty());
+    EXPECT_TRUE(topo.is_isolated(3));
+    EXPECT_FALSE(topo.is_isolated(1));
+
+    EXPECT_EQ(topo.allowed(), std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+    EXPECT_FALSE(topo.is_allowed(0));
+}
+
+TEST_F(fake_topology, place) {
+    cpu_topology topo(m_root.string());
+
+    // Two cores on one socket, no SMT siblings. CPU 0 isn't allowed, so its
+    // sibling 4 stands in for core 0.
+    placement_request request;
+    request.count = 2;
+    EXPECT_EQ(topo.place(request), std::vector<int>({1, 4}));
+
+    // No socket has three physical cores
+    request.count = 3;
+    EXPECT_TRUE(topo.place(request).empty());
+
+    // With SMT siblings, socket 0 has 1, 4 and 5
+    request.no_smt_siblings = false;
+    EXPECT_EQ(topo.place(request), std::vector<int>({1, 4, 5}));
+
+    // Sharing L3 with CPU 7
+    request.share_l3_with = 7;
+    EXPECT_EQ(topo.place(request), std::vector<int>({2, 3, 6}));
+
+    // Isolated only, on socket 0: there are none
+    request.share_l3_with = -1;
+    request.isolated_only = true;
+    request.socket = 0;
+    EXPECT_TRUE(topo.place(request).empty());
+
+    // Too many for one socket
+    request = {};
+    request.count = 5;
+    request.no_smt_siblings = false;
+    request.allowed_only = false;
+    EXPECT_TRUE(topo.place(request).empty());
+    request.count = 4;
+    EXPECT_EQ(topo.place(request), std::vector<int>({0, 1, 4, 5}));
+}
+
+TEST(cpu_topology, missing_root) {
+    EXPECT_THROW(cpu_topology("/nonexistent"), std::runtime_error);
+}
+
+TEST(cpu_topology, running_system) {
+    cpu_topology topo;
+    ASSERT_FALSE(topo.cpus().empty());
+    ASSERT_FALSE(topo.allowed().empty());
+
+    // Every allowed CPU is known, and one of them can be placed on
+    for (const int cpu : topo.allowed()) {
+        EXPECT_NE(topo.cpu(cpu), nullptr) << cpu;
+    }
+    const std::vector<int> placed = topo.place({});
+    ASSERT_EQ(placed.size(), 1u);
+    EXPECT_TRUE(topo.is_allowed(placed[0]));
+}
@@ -0,0 +1,120 @@
+#include "cpptools/fixed_flat_map.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "cpptools/fixed_string.hpp"
+#include "cpptools/fixed_vector.hpp"
+#include "cpptools/shared_memory.hpp"
+
+using cpptools::fixed_flat_map;
+using cpptools::fixed_string;
+
+TEST(fixed_flat_map, insert_and_find) {
+    fixed_flat_map<int, int, 64> m;
+    EXPECT_EQ(m.find(1), nullptr);
+
+    // Inserted out of order, kept sorted
+    for (int i = 63; i >= 0; --i) {
+        const int key = (i * 37) % 64;
+        EXPECT_TRUE(m.insert(key, key * 2).second);
+    }
+    EXPECT_TRUE(m.full());
+    EXPECT_THROW(m.insert(100, 0), std::length_error);
+
+    for (int key = 0; key < 64; ++key) {
+        ASSERT_NE(m.find(key), nullptr);
+        EXPECT_EQ(*m.find(key), key * 2);
+        EXPECT_EQ(m.keys()[key], key);
+    }
+    EXPECT_FALSE(m.contains(-1));
+    EXPECT_FALSE(m.contains(64));
+
+    // Existing keys aren't overwritten by insert
+    EXPECT_FALSE(m.insert(5, 0).second);
+    EXPECT_EQ(m.at(5), 10);
+    EXPECT_FALSE(m.insert_or_assign(5, 0).second);
+    EXPECT_EQ(m.at(5), 0);
+    EXPECT_THROW((void)m.at(64), std::out_of_range);
+}
+
+TEST(fixed_flat_map, erase) {
+    fixed_flat_map<int, int, 8> m;
+    for (int i = 0; i < 8; ++i) {
+        m.insert(i, i);
+    }
+
+    EXPECT_TRUE(m.erase(0));
+    EXPECT_TRUE(m.erase(4));
+    EXPECT_FALSE(m.erase(4));
+    EXPECT_EQ(m.size(), 6);
+    EXPECT_FALSE(m.contains(4));
+    EXPECT_EQ(*m.find(5), 5);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+}
+
+TEST(fixed_flat_map, string_keys) {
+    fixed_flat_map<fixed_string<15>, double, 16> m;
+    m.insert(std::string_view("MSFT"), 1.0);
+    m.insert(std::string_view("AAPL"), 2.0);
+    m.insert(std::string_view("GOOG"), 3.0);
+
+    // Looked up by string_view without building a fixed_string
+    EXPECT_EQ(*m.find(std::string_view("AAPL")), 2.0);
+    EXPECT_EQ(m.find(std::string_view("IBM")), nullptr);
+    EXPECT_EQ(m.keys().front(), "AAPL");
+    EXPECT_EQ(m.keys().back(), "MSFT");
+}
+
+TEST(fixed_flat_map, shared_across_processes) {
+    struct instrument {
+        uint32_t id;
+        double tick_size;
+    };
+    struct catalog {
+        fixed_flat_map<fixed_string<15>, instrument, 256> by_symbol;
+        cpptools::fixed_vector<fixed_string<15>, 256> symbols;
+    };
+    static_assert(std::is_trivially_copyable_v<catalog>);
+
+    // Built in place by the parent, read in place by a child that maps the
+    // segment at its own address
+    cpptools::shared_memory shmem("/test_fixed_flat_map", sizeof(catalog));
+    catalog *c = shmem.as_struct<catalog>();
+    for (uint32_t i = 0; i < 200; ++i) {
+        const std::string symbol = "SYM" + std::to_string(i);
+        c->by_symbol.insert(std::string_view(symbol), instrument{i, 0.01 * i});
+        c->symbols.emplace_back(std::string_view(symbol));
+    }
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        bool ok{true};
+        {
+            cpptools::shared_memory attached("/test_fixed_flat_map",
+                                             sizeof(catalog));
+            const catalog *r = attached.as_struct<catalog>();
+            ok = r != c && r->symbols.size() == 200;
+            for (uint32_t i = 0; i < 200 && ok; ++i) {
+                const instrument *inst = r->by_symbol.find(r->symbols[i]);
+                ok = inst != nullptr && inst->id == i;
+            }
+        }
+        _exit(ok ? 0 : 1);
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
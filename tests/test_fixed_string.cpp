@@ -0,0 +1,62 @@
+#include "cpptools/fixed_string.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+using cpptools::fixed_string;
+
+TEST(fixed_string, layout) {
+    EXPECT_TRUE(std::is_trivially_copyable_v<fixed_string<15>>);
+
+    // Zero-initialized memory is an empty string
+    alignas(fixed_string<15>) std::byte raw[sizeof(fixed_string<15>)]{};
+    const auto *str = reinterpret_cast<const fixed_string<15> *>(raw);
+    EXPECT_TRUE(str->empty());
+    EXPECT_STREQ(str->c_str(), "");
+}
+
+TEST(fixed_string, assign_and_append) {
+    fixed_string<8> s("abc");
+    EXPECT_EQ(s.size(), 3);
+    EXPECT_EQ(s, "abc");
+    EXPECT_STREQ(s.c_str(), "abc");
+
+    s += "de";
+    s.push_back('f');
+    EXPECT_EQ(s.view(), "abcdef");
+    EXPECT_EQ(std::strlen(s.c_str()), 6);
+
+    s = std::string("xy");
+    EXPECT_EQ(s, "xy");
+
+    s.clear();
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(s.capacity(), 8);
+}
+
+TEST(fixed_string, too_long) {
+    EXPECT_THROW(fixed_string<4>("hello"), std::length_error);
+
+    fixed_string<4> s("abcd");
+    EXPECT_THROW(s.push_back('e'), std::length_error);
+    EXPECT_EQ(s, "abcd");
+}
+
+TEST(fixed_string, compare_and_hash) {
+    const fixed_string<8> a("apple");
+    const fixed_string<8> b("banana");
+
+    EXPECT_LT(a, b);
+    EXPECT_GT(b, std::string_view("apricot"));
+    EXPECT_EQ(std::string_view("apple"), a);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(std::hash<fixed_string<8>>{}(a),
+              std::hash<std::string_view>{}("apple"));
+}
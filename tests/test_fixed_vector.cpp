@@ -0,0 +1,78 @@
+#include "cpptools/fixed_vector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+
+#include "cpptools/offset_ptr.hpp"
+
+using cpptools::fixed_vector;
+
+TEST(fixed_vector, layout) {
+    EXPECT_TRUE((std::is_trivially_copyable_v<fixed_vector<int, 4>>));
+    EXPECT_FALSE((std::is_trivially_copyable_v<
+                  fixed_vector<cpptools::offset_ptr<int>, 4>>));
+
+    // Zero-initialized memory is an empty vector
+    using vector_t = fixed_vector<int, 4>;
+    alignas(vector_t) std::byte raw[sizeof(vector_t)]{};
+    EXPECT_TRUE(reinterpret_cast<vector_t *>(raw)->empty());
+}
+
+TEST(fixed_vector, push_and_pop) {
+    fixed_vector<int, 4> v;
+    EXPECT_TRUE(v.empty());
+
+    v.push_back(1);
+    v.emplace_back(2);
+    v.push_back(3);
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v.front(), 1);
+    EXPECT_EQ(v.back(), 3);
+    EXPECT_EQ(std::accumulate(v.begin(), v.end(), 0), 6);
+
+    v.push_back(4);
+    EXPECT_TRUE(v.full());
+    EXPECT_THROW(v.push_back(5), std::length_error);
+
+    v.pop_back();
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v.at(2), 3);
+    EXPECT_THROW((void)v.at(3), std::out_of_range);
+}
+
+TEST(fixed_vector, insert_and_erase) {
+    fixed_vector<int, 8> v{1, 3, 5};
+
+    v.insert(v.begin() + 1, 2);
+    v.insert(v.begin() + 3, 4);
+    v.insert(v.end(), 6);
+    v.insert(v.begin(), 0);
+    EXPECT_EQ(v, (fixed_vector<int, 8>{0, 1, 2, 3, 4, 5, 6}));
+
+    v.erase(v.begin());
+    v.erase(v.begin() + 2);
+    EXPECT_EQ(v, (fixed_vector<int, 8>{1, 2, 4, 5, 6}));
+}
+
+TEST(fixed_vector, non_trivial_elements) {
+    // Copies of offset_ptr elements point where the originals did
+    int values[3] = {10, 20, 30};
+    fixed_vector<cpptools::offset_ptr<int>, 4> a;
+    for (int &value : values) {
+        a.push_back(&value);
+    }
+
+    fixed_vector<cpptools::offset_ptr<int>, 4> b = a;
+    a.clear();
+    ASSERT_EQ(b.size(), 3);
+    EXPECT_EQ(*b[0], 10);
+    EXPECT_EQ(*b[2], 30);
+
+    b.erase(b.begin());
+    EXPECT_EQ(*b[0], 20);
+    EXPECT_EQ(*b[1], 30);
+}
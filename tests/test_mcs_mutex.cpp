@@ -0,0 +1,93 @@
+#include "cpptools/mcs_mutex.hpp"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using cpptools::mcs_mutex;
+
+TEST(mcs_mutex, constructor) { ASSERT_NO_FATAL_FAILURE(mcs_mutex{}); }
+
+TEST(mcs_mutex, try_lock) {
+    mcs_mutex m;
+
+    // Lock once - can't lock again
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+
+    // Unlock - CAN lock again
+    m.unlock();
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(mcs_mutex, nested_mutexes) {
+    mcs_mutex m1;
+    mcs_mutex m2;
+
+    // One thread can hold several MCS mutexes at once, and release them in
+    // any order
+    std::scoped_lock l(m1, m2);
+    EXPECT_FALSE(m1.try_lock());
+    EXPECT_FALSE(m2.try_lock());
+
+    m1.unlock();
+    EXPECT_TRUE(m1.try_lock());
+    m2.unlock();
+    EXPECT_TRUE(m2.try_lock());
+
+    // Leave both locked for scoped_lock to release
+}
+
+TEST(mcs_mutex, fifo_order) {
+    mcs_mutex m;
+    m.lock();
+
+    // Queue up threads one at a time, so that they enqueue in order
+    constexpr int num_threads = 4;
+    std::vector<int> order;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i] {
+            std::scoped_lock l(m);
+            order.push_back(i);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // Release: threads must be served in arrival order
+    m.unlock();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    ASSERT_EQ(order.size(), num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(mcs_mutex, contended) {
+    mcs_mutex m;
+
+    constexpr int num_threads = 4;
+    constexpr int num_iters = 10000;
+    int counter{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < num_iters; ++j) {
+                std::scoped_lock l(m);
+                ++counter;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(counter, num_threads * num_iters);
+}
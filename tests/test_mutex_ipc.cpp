@@ -0,0 +1,101 @@
+#include "cpptools/mutex_ipc.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include "cpptools/adaptive_mutex_ipc.hpp"
+#include "cpptools/shared_memory.hpp"
+#include "cpptools/shared_spinlock_mutex_ipc.hpp"
+#include "cpptools/ticket_mutex_ipc.hpp"
+
+using cpptools::shared_memory;
+
+const std::string g_name = "/testing";
+const std::string g_counter_name = "/testing_counter";
+
+// Every mutex_ipc whose exclusive lock follows the std::mutex interface
+template <typename T>
+class mutex_ipc : public testing::Test {};
+
+using mutex_ipc_types =
+    testing::Types<cpptools::adaptive_mutex_ipc, cpptools::ticket_mutex_ipc,
+                   cpptools::shared_spinlock_mutex_ipc>;
+
+struct mutex_ipc_names {
+    template <typename T>
+    static std::string GetName(int) {
+        if constexpr (std::is_same_v<T, cpptools::adaptive_mutex_ipc>) {
+            return "adaptive_mutex_ipc";
+        } else if constexpr (std::is_same_v<T, cpptools::ticket_mutex_ipc>) {
+            return "ticket_mutex_ipc";
+        } else {
+            return "shared_spinlock_mutex_ipc";
+        }
+    }
+};
+
+TYPED_TEST_SUITE(mutex_ipc, mutex_ipc_types, mutex_ipc_names);
+
+TYPED_TEST(mutex_ipc, constructor) {
+    ASSERT_NO_FATAL_FAILURE(TypeParam{g_name});
+
+    TypeParam lock(g_name);
+    EXPECT_EQ(lock.name(), g_name);
+    EXPECT_EQ(lock.reference_count(), 1);
+}
+
+TYPED_TEST(mutex_ipc, lock_unlock) {
+    TypeParam lock1(g_name);
+    EXPECT_TRUE(lock1.try_lock());
+
+    {
+        TypeParam lock2(g_name);
+        EXPECT_EQ(lock2.reference_count(), 2);
+        EXPECT_FALSE(lock2.try_lock());
+    }
+
+    EXPECT_FALSE(lock1.try_lock());
+    EXPECT_NO_THROW(lock1.unlock());
+    EXPECT_TRUE(lock1.try_lock());
+    EXPECT_NO_THROW(lock1.unlock());
+}
+
+TYPED_TEST(mutex_ipc, cross_process) {
+    constexpr int num_iters = 10000;
+
+    TypeParam lock(g_name);
+    shared_memory counter_mem(g_counter_name, sizeof(int));
+    int *counter = counter_mem.as_struct<int>();
+    *counter = 0;
+
+    // Parent and child increment a shared counter under the lock
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        {
+            TypeParam child_lock(g_name);
+            shared_memory child_mem(g_counter_name, sizeof(int));
+            int *child_counter = child_mem.as_struct<int>();
+            for (int i = 0; i < num_iters; ++i) {
+                std::scoped_lock l(child_lock);
+                ++*child_counter;
+            }
+        }
+        _exit(0);
+    }
+
+    for (int i = 0; i < num_iters; ++i) {
+        std::scoped_lock l(lock);
+        ++*counter;
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(*counter, 2 * num_iters);
+}
@@ -0,0 +1,72 @@
+#include "cpptools/numa.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+using cpptools::numa_policy;
+
+TEST(numa, parse_list) {
+    EXPECT_EQ(cpptools::numa::parse_list("0"), std::vector<int>({0}));
+    EXPECT_EQ(cpptools::numa::parse_list("0-3\n"),
+              std::vector<int>({0, 1, 2, 3}));
+    EXPECT_EQ(cpptools::numa::parse_list("0,2-3,7"),
+              std::vector<int>({0, 2, 3, 7}));
+    EXPECT_EQ(cpptools::numa::parse_list("\t1-2 \n"),
+              std::vector<int>({1, 2}));
+    EXPECT_TRUE(cpptools::numa::parse_list("").empty());
+    EXPECT_TRUE(cpptools::numa::parse_list("\n").empty());
+}
+
+TEST(numa, online_nodes) {
+    // Every system has node 0
+    const std::vector<int> nodes = cpptools::numa::online_nodes();
+    ASSERT_FALSE(nodes.empty());
+    EXPECT_NE(std::find(nodes.begin(), nodes.end(), 0), nodes.end());
+}
+
+TEST(numa, node_of_cpu) {
+    EXPECT_GE(cpptools::numa::node_of_cpu(0), 0);
+    EXPECT_EQ(cpptools::numa::node_of_cpu(1 << 20), -1);
+    EXPECT_EQ(cpptools::numa::node_of_cpu(-1), -1);
+}
+
+TEST(numa, bind_memory_and_residency) {
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t len = 16 * page;
+    void *mem = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mem, MAP_FAILED);
+
+    // Nothing touched yet
+    cpptools::numa::residency before =
+        cpptools::numa::page_residency(mem, len, page);
+    EXPECT_EQ(before.not_present, 16u);
+
+    // Bind to node 0 and touch every page
+    const int node = 0;
+    const int err = cpptools::numa::bind_memory(mem, len, numa_policy::bind,
+                                                std::span(&node, 1));
+    EXPECT_TRUE(err == 0 || err == ENOSYS);
+    std::memset(mem, 1, len);
+
+    cpptools::numa::residency after =
+        cpptools::numa::page_residency(mem, len, page);
+    EXPECT_EQ(after.not_present, 0u);
+    ASSERT_FALSE(after.pages_per_node.empty());
+    EXPECT_EQ(after.pages_per_node[0], 16u);
+
+    // Only bind and interleave are memory policies
+    EXPECT_EQ(cpptools::numa::bind_memory(mem, len, numa_policy::local_to_core,
+                                          std::span(&node, 1)),
+              EINVAL);
+
+    munmap(mem, len);
+}
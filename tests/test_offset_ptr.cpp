@@ -0,0 +1,85 @@
+#include "cpptools/offset_ptr.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <type_traits>
+
+#include "cpptools/shared_memory.hpp"
+
+using cpptools::offset_ptr;
+
+TEST(offset_ptr, null) {
+    offset_ptr<int> p;
+    EXPECT_FALSE(p);
+    EXPECT_EQ(p.get(), nullptr);
+    EXPECT_EQ(p, nullptr);
+
+    // Zero-initialized memory is a null pointer
+    alignas(offset_ptr<int>) std::byte raw[sizeof(offset_ptr<int>)]{};
+    EXPECT_EQ(reinterpret_cast<offset_ptr<int> *>(raw)->get(), nullptr);
+}
+
+TEST(offset_ptr, points_and_copies) {
+    int values[4] = {1, 2, 3, 4};
+
+    offset_ptr<int> p(&values[1]);
+    EXPECT_TRUE(p);
+    EXPECT_EQ(p.get(), &values[1]);
+    EXPECT_EQ(*p, 2);
+    EXPECT_EQ(p[1], 3);
+
+    // Copies point at the same object from their own address
+    offset_ptr<int> q = p;
+    EXPECT_EQ(q.get(), &values[1]);
+    offset_ptr<const int> c = q;
+    EXPECT_EQ(c.get(), &values[1]);
+
+    ++q;
+    EXPECT_EQ(*q, 3);
+    EXPECT_EQ(q - p, 1);
+    EXPECT_LT(p, q);
+    EXPECT_EQ(*(p + 2), 4);
+    EXPECT_EQ(*(q - 2), 1);
+
+    q = nullptr;
+    EXPECT_FALSE(q);
+}
+
+TEST(offset_ptr, layout) {
+    EXPECT_FALSE(std::is_trivially_copyable_v<offset_ptr<int>>);
+    EXPECT_EQ(sizeof(offset_ptr<int>), sizeof(std::ptrdiff_t));
+}
+
+TEST(offset_ptr, survives_remapping) {
+    struct node {
+        int value;
+        offset_ptr<node> next;
+    };
+    struct list {
+        offset_ptr<node> head;
+        node nodes[8];
+    };
+
+    // Two mappings of one segment sit at different addresses in this
+    // process, just as they would in two processes
+    cpptools::shared_memory writer("/test_offset_ptr", sizeof(list));
+    cpptools::shared_memory reader("/test_offset_ptr", sizeof(list));
+    ASSERT_NE(writer.data(), reader.data());
+
+    list *w = writer.as_struct<list>();
+    for (int i = 0; i < 8; ++i) {
+        w->nodes[i].value = i * 10;
+        w->nodes[i].next = i < 7 ? &w->nodes[i + 1] : nullptr;
+    }
+    w->head = &w->nodes[0];
+
+    const list *r = reader.as_struct<list>();
+    int count{0};
+    for (const node *n = r->head.get(); n != nullptr; n = n->next.get()) {
+        EXPECT_EQ(n, &r->nodes[count]);
+        EXPECT_EQ(n->value, count * 10);
+        ++count;
+    }
+    EXPECT_EQ(count, 8);
+}
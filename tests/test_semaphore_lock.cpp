@@ -1,14 +1,23 @@
 #include <gtest/gtest.h>
 #include <linux/limits.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <stdexcept>
+#include <thread>
 
 #include "cpptools/semaphore_lock.hpp"
 
 const char* g_valid_name = "/testing";
 
+using cpptools::semaphore_guard;
 using cpptools::semaphore_lock;
+using cpptools::semaphore_mode;
+using cpptools::semaphore_options;
 
 TEST(semaphore_lock, constructor) {
     // Construct semaphore lock on /testing
@@ -60,3 +69,172 @@ TEST(semaphore_lock, destructor_release) {
     EXPECT_TRUE(semlock1.lock());
     EXPECT_TRUE(semlock1.unlock());
 }
+
+TEST(semaphore_lock, try_lock_and_available) {
+    semaphore_lock::remove(g_valid_name);
+    semaphore_lock semlock1(g_valid_name);
+    semaphore_lock semlock2(g_valid_name);
+    EXPECT_EQ(semlock1.available(), 1);
+
+    EXPECT_TRUE(semlock1.try_lock());
+    EXPECT_TRUE(semlock1.owns_lock());
+    EXPECT_EQ(semlock2.available(), 0);
+    EXPECT_FALSE(semlock2.try_lock());
+    EXPECT_FALSE(semlock2.owns_lock());
+
+    // Taking it again is a no-op
+    EXPECT_TRUE(semlock1.try_lock());
+    EXPECT_TRUE(semlock1.unlock());
+    EXPECT_FALSE(semlock1.unlock());
+    EXPECT_EQ(semlock1.available(), 1);
+}
+
+TEST(semaphore_lock, permits) {
+    semaphore_lock::remove("/testing_permits");
+    semaphore_options options;
+    options.permits = 3;
+
+    semaphore_lock semlock1("/testing_permits", options);
+    semaphore_lock semlock2("/testing_permits", options);
+    semaphore_lock semlock3("/testing_permits", options);
+    semaphore_lock semlock4("/testing_permits");
+    EXPECT_EQ(semlock1.available(), 3);
+
+    // Three holders at once, not four
+    EXPECT_TRUE(semlock1.lock());
+    EXPECT_TRUE(semlock2.lock());
+    EXPECT_TRUE(semlock3.lock());
+    int err{0};
+    EXPECT_FALSE(semlock4.lock(err));
+    EXPECT_EQ(err, EAGAIN);
+
+    EXPECT_TRUE(semlock2.unlock());
+    EXPECT_TRUE(semlock4.lock());
+    EXPECT_EQ(semlock4.available(), 0);
+    semaphore_lock::remove("/testing_permits");
+
+    options.permits = 0;
+    EXPECT_THROW(semaphore_lock("/testing_permits", options),
+                 std::length_error);
+}
+
+TEST(semaphore_lock, timed) {
+    using clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    semaphore_lock::remove(g_valid_name);
+    semaphore_options options;
+    options.mode = semaphore_mode::timed;
+    options.timeout = milliseconds(20);
+
+    semaphore_lock semlock1(g_valid_name);
+    semaphore_lock semlock2(g_valid_name, options);
+    EXPECT_TRUE(semlock1.lock());
+
+    // Gives up after the timeout
+    auto start = clock::now();
+    int err{0};
+    EXPECT_FALSE(semlock2.lock(err));
+    EXPECT_EQ(err, ETIMEDOUT);
+    EXPECT_GE(clock::now() - start, milliseconds(20));
+
+    start = clock::now();
+    EXPECT_FALSE(semlock2.lock_for(milliseconds(5)));
+    EXPECT_GE(clock::now() - start, milliseconds(5));
+
+    // A deadline in the past is a try
+    EXPECT_FALSE(semlock2.lock_until(clock::now() - milliseconds(1)));
+
+    // Succeeds once the permit is released in time
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(milliseconds(5));
+        semlock1.unlock();
+    });
+    EXPECT_TRUE(semlock2.lock_for(std::chrono::seconds(5)));
+    releaser.join();
+    EXPECT_TRUE(semlock2.unlock());
+}
+
+// Holds the semaphore briefly while lock() in the given mode waits for it
+void expect_waits_for_release(semaphore_mode mode) {
+    using std::chrono::milliseconds;
+
+    semaphore_lock::remove(g_valid_name);
+    semaphore_options options;
+    options.mode = mode;
+
+    semaphore_lock holder(g_valid_name);
+    semaphore_lock waiter(g_valid_name, options);
+    EXPECT_TRUE(holder.lock());
+
+    std::atomic<bool> released{false};
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(milliseconds(10));
+        released = true;
+        holder.unlock();
+    });
+    EXPECT_TRUE(waiter.lock());
+    EXPECT_TRUE(released.load());
+    releaser.join();
+    EXPECT_TRUE(waiter.unlock());
+}
+
+TEST(semaphore_lock, blocking) {
+    expect_waits_for_release(semaphore_mode::blocking);
+}
+
+TEST(semaphore_lock, spin_then_block) {
+    expect_waits_for_release(semaphore_mode::spin_then_block);
+}
+
+TEST(semaphore_lock, guard) {
+    semaphore_lock::remove(g_valid_name);
+    semaphore_lock semlock1(g_valid_name);
+    semaphore_lock semlock2(g_valid_name);
+
+    {
+        semaphore_guard guard(semlock1);
+        EXPECT_TRUE(guard.owns_lock());
+        EXPECT_TRUE(semlock1.owns_lock());
+
+        // No permit left by the deadline
+        semaphore_guard timed_out(
+            semlock2,
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
+        EXPECT_FALSE(timed_out);
+    }
+
+    // Released on scope exit
+    EXPECT_FALSE(semlock1.owns_lock());
+    EXPECT_EQ(semlock1.available(), 1);
+}
+
+TEST(semaphore_lock, across_processes) {
+    semaphore_lock::remove(g_valid_name);
+    semaphore_lock semlock(g_valid_name);
+    EXPECT_TRUE(semlock.lock());
+
+    // The child blocks until the parent lets go
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        bool locked{false};
+        {
+            semaphore_options options;
+            options.mode = semaphore_mode::blocking;
+            semaphore_lock child(g_valid_name, options);
+            locked = child.lock();
+        }
+        _exit(locked ? 0 : 1);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(waitpid(pid, nullptr, WNOHANG), 0);
+    EXPECT_TRUE(semlock.unlock());
+
+    int status{0};
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(semlock.available(), 1);
+}
@@ -0,0 +1,132 @@
+#include "cpptools/seqlock.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+
+using cpptools::seqlock;
+
+// Snapshot whose fields must all agree, to catch torn reads
+struct quote {
+    uint64_t seq;
+    double bid;
+    double ask;
+    uint32_t size[5];
+
+    static quote of(uint64_t n) {
+        const auto d = static_cast<double>(n);
+        const auto u = static_cast<uint32_t>(n);
+        return {n, d, d, {u, u, u, u, u}};
+    }
+    bool consistent() const {
+        const auto u = static_cast<uint32_t>(seq);
+        return bid == static_cast<double>(seq) && ask == bid &&
+               size[0] == u && size[1] == u && size[2] == u && size[3] == u &&
+               size[4] == u;
+    }
+};
+
+TEST(seqlock, read_write) {
+    seqlock<quote> lock;
+    EXPECT_EQ(lock.version(), 0);
+    EXPECT_EQ(lock.read().seq, 0);
+
+    lock.write(quote::of(42));
+    EXPECT_EQ(lock.version(), 1);
+    EXPECT_EQ(lock.read().seq, 42);
+    EXPECT_TRUE(lock.read().consistent());
+
+    quote q{};
+    EXPECT_TRUE(lock.try_read(q));
+    EXPECT_EQ(q.seq, 42);
+
+    // No attempts, no value
+    q = quote{};
+    EXPECT_FALSE(lock.try_read(q, 0));
+    EXPECT_EQ(q.seq, 0);
+
+    seqlock<int> initialized(7);
+    EXPECT_EQ(initialized.read(), 7);
+}
+
+TEST(seqlock, concurrent_readers_and_writers) {
+    seqlock<quote> lock(quote::of(0));
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                quote q{};
+                if (!lock.try_read(q)) {
+                    continue;
+                }
+                torn += !q.consistent();
+            }
+        });
+    }
+
+    // Two writers taking turns
+    std::atomic<uint64_t> next{1};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&] {
+            for (int i = 0; i < 50000; ++i) {
+                lock.write(quote::of(next.fetch_add(1)));
+            }
+        });
+    }
+    for (auto &t : writers) {
+        t.join();
+    }
+    stop = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(lock.version(), 100000);
+    EXPECT_TRUE(lock.read().consistent());
+}
+
+TEST(seqlock, shared_memory) {
+    cpptools::shared_memory shmem("/test_seqlock", sizeof(seqlock<quote>));
+    auto *lock = shmem.as_struct<seqlock<quote>>();
+    ASSERT_NE(lock, nullptr);
+
+    // Zero-initialized shared memory is an all-zero value
+    EXPECT_EQ(lock->version(), 0);
+    EXPECT_TRUE(lock->read().consistent());
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        {
+            cpptools::shared_memory attached("/test_seqlock",
+                                             sizeof(seqlock<quote>));
+            auto *writer = attached.as_struct<seqlock<quote>>();
+            for (uint64_t n = 1; n <= 10000; ++n) {
+                writer->write(quote::of(n));
+            }
+        }
+        _exit(0);
+    }
+
+    uint64_t torn{0};
+    int status{0};
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        torn += !lock->read().consistent();
+    }
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(lock->read().seq, 10000);
+    EXPECT_EQ(lock->version(), 10000);
+}
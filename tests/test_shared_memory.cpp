@@ -1,14 +1,28 @@
 #include <fcntl.h>
 #include <gtest/gtest.h>
+#include <linux/capability.h>
 #include <linux/limits.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <format>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include "cpptools/shared_memory.hpp"
 
@@ -270,3 +284,764 @@ void request_shared_mem(const char *name, size_t size) {
 }
 
 void free_shared_mem(const char *name) { shm_unlink(name); }
+
+TEST(shared_memory, concurrent_create_threads) {
+    constexpr int threads = 8;
+    constexpr int rounds = 200;
+
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // Every round, all threads create-or-attach at once, and must end up
+    // sharing one segment
+    for (int round = 0; round < rounds; ++round) {
+        std::atomic<int> arrived{0};
+        std::atomic<int> attached{0};
+        std::atomic<int> failures{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                ++arrived;
+                while (arrived.load() < threads) {
+                    std::this_thread::yield();
+                }
+
+                shared_memory shmem(g_valid_name, g_size);
+                auto *users = reinterpret_cast<int *>(shmem.data());
+                std::atomic_ref<int>(*users).fetch_add(1);
+                ++attached;
+                while (attached.load() < threads) {
+                    std::this_thread::yield();
+                }
+
+                failures += std::atomic_ref<int>(*users).load() != threads;
+                failures += shmem.reference_count() < 1;
+            });
+        }
+        for (auto &t : workers) {
+            t.join();
+        }
+        ASSERT_EQ(failures.load(), 0) << "round " << round;
+        ASSERT_FALSE(shared_mem_exists(g_valid_name)) << "round " << round;
+    }
+}
+
+TEST(shared_memory, concurrent_create_processes) {
+    constexpr int processes = 4;
+    constexpr int attaches = 500;
+
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // Processes keep creating, attaching to and destroying the segment.
+    // Whoever gets it must find it initialized and in use by at most all of
+    // them.
+    std::vector<pid_t> pids;
+    for (int p = 0; p < processes; ++p) {
+        const pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            int failures{0};
+            for (int i = 0; i < attaches; ++i) {
+                try {
+                    shared_memory shmem(g_valid_name, g_size);
+                    auto *users = reinterpret_cast<int *>(shmem.data());
+                    const int n = std::atomic_ref<int>(*users).fetch_add(1);
+                    failures += n < 0 || n >= processes;
+                    failures += shmem.reference_count() < 1;
+                    std::atomic_ref<int>(*users).fetch_sub(1);
+                } catch (...) {
+                    ++failures;
+                }
+            }
+            _exit(failures);
+        }
+        pids.push_back(pid);
+    }
+
+    for (pid_t pid : pids) {
+        int status{0};
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+
+    // The last one out removed it
+    EXPECT_FALSE(shared_mem_exists(g_valid_name));
+}
+
+TEST(shared_memory, attach_timeout) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    cpptools::shared_memory_options options;
+    options.attach_timeout = std::chrono::milliseconds(10);
+
+    // A segment that was never sized...
+    request_shared_mem(g_valid_name, 0);
+    EXPECT_THROW(shared_memory(g_valid_name, g_size, options),
+                 std::runtime_error);
+    free_shared_mem(g_valid_name);
+
+    // ...or never marked initialized by a creator that hasn't recorded
+    // itself yet
+    request_shared_mem(g_valid_name, g_size + CPPTOOLS_CACHELINE_SIZE);
+    EXPECT_THROW(shared_memory(g_valid_name, g_size, options),
+                 std::runtime_error);
+    free_shared_mem(g_valid_name);
+}
+
+TEST(shared_memory, creator_killed_before_ready) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // Mirrors the segment's header, which sits a cacheline before the data
+    struct header {
+        int reference_count;
+        uint32_t grow_lock;
+        uint64_t generation;
+        uint64_t data_size;
+        uint32_t state;
+        pid_t creator;
+    };
+
+    // The child creates the segment, puts it back to initializing and is
+    // killed, as if it died between creating the segment and marking it
+    // ready
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        shared_memory shmem(g_valid_name, g_size);
+        auto *h = reinterpret_cast<header *>(
+            static_cast<std::byte *>(shmem.data()) - CPPTOOLS_CACHELINE_SIZE);
+        if (h->creator != getpid()) {
+            _exit(1);
+        }
+        h->state = 0;
+        raise(SIGKILL);
+    }
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    ASSERT_TRUE(shared_mem_exists(g_valid_name));
+
+    // The next process replaces the stale segment rather than timing out
+    cpptools::shared_memory_options options;
+    options.attach_timeout = std::chrono::seconds(2);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        EXPECT_LT(std::chrono::steady_clock::now() - start,
+                  options.attach_timeout);
+        EXPECT_EQ(shmem.reference_count(), 1);
+    }
+    EXPECT_FALSE(shared_mem_exists(g_valid_name));
+}
+
+TEST(shared_memory, huge_pages_or_fallback) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // Either we get huge pages, or a normal segment and a reason why not
+    cpptools::shared_memory_options options;
+    options.pages = cpptools::page_size::huge_2mb;
+    shared_memory shmem(g_valid_name, g_size, options);
+    if (shmem.huge_pages()) {
+        EXPECT_EQ(shmem.page_bytes(), size_t{2} << 20);
+        EXPECT_TRUE(shmem.fallback_reason().empty());
+    } else {
+        EXPECT_EQ(shmem.page_bytes(), size_t(sysconf(_SC_PAGESIZE)));
+        EXPECT_FALSE(shmem.fallback_reason().empty());
+        EXPECT_TRUE(shared_mem_exists(g_valid_name));
+    }
+
+    // Memory is usable either way
+    std::span<std::byte> span = shmem.as_span<std::byte>();
+    EXPECT_EQ(span.size(), g_size);
+    std::memset(span.data(), 'a', span.size());
+    EXPECT_EQ(span.back(), std::byte('a'));
+}
+
+TEST(shared_memory, huge_pages_fallback_without_mount) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // A hugetlbfs mount that doesn't exist forces a fallback
+    cpptools::shared_memory_options options;
+    options.pages = cpptools::page_size::huge_2mb;
+    options.hugetlbfs_mount = "/nonexistent";
+    shared_memory shmem(g_valid_name, g_size, options);
+    EXPECT_FALSE(shmem.huge_pages());
+    EXPECT_FALSE(shmem.fallback_reason().empty());
+    EXPECT_EQ(shmem.size(), g_size);
+    EXPECT_TRUE(shared_mem_exists(g_valid_name));
+}
+
+TEST(shared_memory, page_in_options) {
+    using std::chrono::nanoseconds;
+
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // No page-in steps requested: only mapping takes time
+    {
+        shared_memory shmem(g_valid_name, g_size);
+        EXPECT_GT(shmem.attach_timings().map, nanoseconds(0));
+        EXPECT_EQ(shmem.attach_timings().advise, nanoseconds(0));
+        EXPECT_EQ(shmem.attach_timings().prefault, nanoseconds(0));
+        EXPECT_EQ(shmem.attach_timings().lock, nanoseconds(0));
+    }
+
+    // All steps requested: each one reports its duration
+    cpptools::shared_memory_options options;
+    options.populate = true;
+    options.prefault = true;
+    options.lock_pages = true;
+    options.advice = MADV_WILLNEED;
+
+    shared_memory shmem1(g_valid_name, g_size, options);
+    EXPECT_GT(shmem1.attach_timings().map, nanoseconds(0));
+    EXPECT_GT(shmem1.attach_timings().advise, nanoseconds(0));
+    EXPECT_GT(shmem1.attach_timings().prefault, nanoseconds(0));
+    EXPECT_GT(shmem1.attach_timings().lock, nanoseconds(0));
+
+    // Prefaulting an attached segment leaves its contents alone
+    std::span<std::byte> span1 = shmem1.as_span<std::byte>();
+    std::memset(span1.data(), 'a', span1.size());
+    {
+        shared_memory shmem2(g_valid_name, g_size, options);
+        for (std::byte byte : shmem2.as_span<std::byte>()) {
+            ASSERT_EQ(byte, std::byte('a'));
+        }
+    }
+}
+
+TEST(shared_memory, page_in_invalid_advice) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // Failed steps throw
+    cpptools::shared_memory_options options;
+    options.advice = -1;
+    EXPECT_THROW(shared_memory(g_valid_name, g_size, options),
+                 std::runtime_error);
+}
+
+// Makes mlock() fail in this process: drops CAP_IPC_LOCK, if it has it, and
+// allows no locked memory
+static void forbid_mlock() {
+    __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+    __user_cap_data_struct caps[_LINUX_CAPABILITY_U32S_3]{};
+    if (syscall(SYS_capget, &header, caps) == 0) {
+        caps[CAP_TO_INDEX(CAP_IPC_LOCK)].effective &=
+            ~CAP_TO_MASK(CAP_IPC_LOCK);
+        syscall(SYS_capset, &header, caps);
+    }
+    const rlimit none{0, 0};
+    setrlimit(RLIMIT_MEMLOCK, &none);
+}
+
+TEST(shared_memory, page_in_failure_leaves_segment_usable) {
+    constexpr size_t size = 64 << 20;
+
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // The child creates the segment and fails to lock it in memory, after
+    // prefaulting it for long enough that the parent attaches meanwhile
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        forbid_mlock();
+        cpptools::shared_memory_options options;
+        options.prefault = true;
+        options.lock_pages = true;
+        int result{0};
+        try {
+            shared_memory shmem(g_valid_name, size, options);
+            result = 2;
+        } catch (const std::runtime_error &) {
+        }
+        _exit(result);
+    }
+
+    while (!shared_mem_exists(g_valid_name)) {
+        std::this_thread::yield();
+    }
+    shared_memory attached(g_valid_name, size);
+
+    int status{0};
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    if (WEXITSTATUS(status) == 2) {
+        GTEST_SKIP() << "mlock can't be made to fail here";
+    }
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // Paging in is per process: the segment is still initialized and in
+    // use, so newcomers attach to it
+    cpptools::shared_memory_options options;
+    options.attach_timeout = std::chrono::milliseconds(100);
+    shared_memory again(g_valid_name, size, options);
+    EXPECT_EQ(again.reference_count(), 2);
+}
+
+TEST(shared_memory, numa_bind) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // No policy by default
+    {
+        shared_memory shmem(g_valid_name, g_size);
+        EXPECT_TRUE(shmem.numa_nodes().empty());
+        EXPECT_TRUE(shmem.numa_fallback_reason().empty());
+    }
+
+    // Bound and populated segment resides on the node, header page
+    // included. The last node is the least likely to be local.
+    const std::vector<int> online = cpptools::numa::online_nodes();
+    if (online.empty()) {
+        GTEST_SKIP() << "no NUMA nodes online";
+    }
+    const int node = online.back();
+    cpptools::shared_memory_options options;
+    options.numa = cpptools::numa_policy::bind;
+    options.numa_nodes = {node};
+    options.populate = true;
+
+    shared_memory shmem(g_valid_name, g_size, options);
+    if (!shmem.numa_fallback_reason().empty()) {
+        GTEST_SKIP() << shmem.numa_fallback_reason();
+    }
+    EXPECT_EQ(shmem.numa_nodes(), std::vector<int>({node}));
+
+    cpptools::numa::residency residency = shmem.numa_residency();
+    EXPECT_EQ(residency.not_present, 0u);
+    ASSERT_GT(residency.pages_per_node.size(), static_cast<size_t>(node));
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t pages = (g_size + CPPTOOLS_CACHELINE_SIZE + page - 1) / page;
+    EXPECT_EQ(residency.pages_per_node[node], pages);
+}
+
+TEST(shared_memory, numa_interleave_and_local_to_core) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    cpptools::shared_memory_options options;
+    options.numa = cpptools::numa_policy::interleave;
+    options.numa_nodes = cpptools::numa::online_nodes();
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        if (shmem.numa_fallback_reason().empty()) {
+            EXPECT_EQ(shmem.numa_nodes(), options.numa_nodes);
+        }
+    }
+
+    // Resolves to the node of the core
+    options.numa = cpptools::numa_policy::local_to_core;
+    options.numa_core = 0;
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        if (shmem.numa_fallback_reason().empty()) {
+            EXPECT_EQ(shmem.numa_nodes(),
+                      std::vector<int>({cpptools::numa::node_of_cpu(0)}));
+        }
+    }
+
+    // Unknown core skips the policy
+    options.numa_core = 1 << 20;
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        EXPECT_TRUE(shmem.numa_nodes().empty());
+        EXPECT_FALSE(shmem.numa_fallback_reason().empty());
+    }
+}
+
+TEST(shared_memory, numa_offline_nodes_dropped) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    // A node that can't be online is dropped with a note
+    constexpr int offline_node = 1023;
+    cpptools::shared_memory_options options;
+    options.numa = cpptools::numa_policy::bind;
+    options.numa_nodes = {0, offline_node};
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        EXPECT_NE(shmem.numa_fallback_reason().find("1023"),
+                  std::string::npos);
+        EXPECT_TRUE(shmem.numa_nodes().empty() ||
+                    shmem.numa_nodes() == std::vector<int>({0}));
+    }
+
+    // With none left the policy is skipped
+    options.numa_nodes = {offline_node};
+    {
+        shared_memory shmem(g_valid_name, g_size, options);
+        EXPECT_TRUE(shmem.numa_nodes().empty());
+        EXPECT_NE(shmem.numa_fallback_reason().find("skipped"),
+                  std::string::npos);
+    }
+}
+
+TEST(shared_memory, grow_in_place) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    cpptools::shared_memory_options options;
+    options.max_size = 16 * g_size;
+
+    shared_memory owner(g_valid_name, g_size, options);
+    shared_memory attached(g_valid_name, g_size, options);
+    EXPECT_TRUE(owner.growable());
+    EXPECT_EQ(owner.max_size(), 16 * g_size);
+    EXPECT_EQ(owner.generation(), 0);
+    EXPECT_FALSE(attached.refresh());
+
+    auto *bytes = reinterpret_cast<unsigned char *>(owner.data());
+    std::memset(bytes, 'a', g_size);
+
+    // Grows without moving, keeping the contents
+    void *const data = owner.data();
+    EXPECT_TRUE(owner.grow(4 * g_size));
+    EXPECT_EQ(owner.data(), data);
+    EXPECT_EQ(owner.size(), 4 * g_size);
+    EXPECT_EQ(owner.generation(), 1);
+    EXPECT_EQ(bytes[g_size - 1], 'a');
+    EXPECT_EQ(bytes[g_size], 0);
+    std::memset(bytes + g_size, 'b', 3 * g_size);
+
+    // Shrinking is a no-op
+    EXPECT_TRUE(owner.grow(g_size));
+    EXPECT_EQ(owner.size(), 4 * g_size);
+    EXPECT_EQ(owner.generation(), 1);
+
+    // Attached instances see the growth once they refresh
+    EXPECT_EQ(attached.size(), g_size);
+    EXPECT_TRUE(attached.refresh());
+    EXPECT_FALSE(attached.refresh());
+    EXPECT_EQ(attached.size(), 4 * g_size);
+    const auto *seen = reinterpret_cast<unsigned char *>(attached.data());
+    EXPECT_EQ(seen[4 * g_size - 1], 'b');
+
+    // New instances attach at the grown size
+    {
+        shared_memory late(g_valid_name, g_size, options);
+        EXPECT_EQ(late.size(), 4 * g_size);
+        EXPECT_FALSE(late.refresh());
+    }
+
+    // Limits
+    EXPECT_THROW(owner.grow(16 * g_size + 1), std::length_error);
+    options.max_size = g_size;
+    EXPECT_THROW(shared_memory("/testing_growable", 2 * g_size, options),
+                 std::length_error);
+}
+
+TEST(shared_memory, grow_not_growable) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    shared_memory shmem(g_valid_name, g_size);
+    EXPECT_FALSE(shmem.growable());
+    EXPECT_THROW(shmem.grow(2 * g_size), std::logic_error);
+    EXPECT_FALSE(shmem.refresh());
+}
+
+TEST(shared_memory, grow_across_processes) {
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    cpptools::shared_memory_options options;
+    options.max_size = 64 * g_size;
+    shared_memory shmem(g_valid_name, g_size, options);
+    auto *words = reinterpret_cast<uint64_t *>(shmem.data());
+
+    // The child grows the segment a page at a time, writing the new size at
+    // its start and at its end
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        int failures{0};
+        {
+            shared_memory owner(g_valid_name, g_size, options);
+            auto *owned = reinterpret_cast<uint64_t *>(owner.data());
+            for (size_t size = g_size + 4096; size <= 8 * g_size;
+                 size += 4096) {
+                failures += !owner.grow(size);
+                owned[size / 8 - 1] = size;
+                std::atomic_ref<uint64_t>(owned[0]).store(
+                    size, std::memory_order_release);
+            }
+        }
+        _exit(failures);
+    }
+
+    // Lazily remap, and check that the latest size the child announced is
+    // both mapped and written
+    uint64_t checked{0};
+    uint64_t bad{0};
+    int status{0};
+    auto check = [&] {
+        const uint64_t size =
+            std::atomic_ref<uint64_t>(words[0]).load(std::memory_order_acquire);
+        if (size > shmem.size()) {
+            shmem.refresh();
+        }
+        if (size != 0) {
+            bad += size > shmem.size() || words[size / 8 - 1] != size;
+            ++checked;
+        }
+    };
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        check();
+    }
+    check();
+
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_GT(checked, 0);
+    EXPECT_EQ(bad, 0);
+    EXPECT_EQ(shmem.size(), 8 * g_size);
+    EXPECT_EQ(shmem.data(), reinterpret_cast<void *>(words));
+}
+
+TEST(shared_memory, memfd_create_and_attach) {
+    using cpptools::memfd;
+
+    // Make sure shared memory doesn't exist
+    if (shared_mem_exists(g_valid_name)) {
+        free_shared_mem(g_valid_name);
+    }
+    ASSERT_FALSE(shared_mem_exists(g_valid_name));
+
+    {
+        shared_memory shmem(memfd, g_valid_name, g_size);
+        EXPECT_TRUE(shmem.anonymous());
+        EXPECT_NE(shmem.fd(), -1);
+        EXPECT_EQ(shmem.name(), g_valid_name);
+        EXPECT_EQ(shmem.size(), g_size);
+        EXPECT_EQ(shmem.reference_count(), 1);
+
+        // Nothing under /dev/shm
+        EXPECT_FALSE(shared_mem_exists(g_valid_name));
+
+        std::span<std::byte> bytes = shmem.as_span<std::byte>();
+        std::memset(bytes.data(), 'a', bytes.size());
+
+        // Attach through the descriptor, which stays the caller's
+        {
+            shared_memory attached(memfd, shmem.fd(), g_size);
+            EXPECT_TRUE(attached.anonymous());
+            EXPECT_NE(attached.fd(), shmem.fd());
+            EXPECT_EQ(attached.name(), g_valid_name);
+            EXPECT_EQ(attached.reference_count(), 2);
+            for (std::byte byte : attached.as_span<std::byte>()) {
+                ASSERT_EQ(byte, std::byte('a'));
+            }
+        }
+        EXPECT_EQ(shmem.reference_count(), 1);
+        EXPECT_NE(fcntl(shmem.fd(), F_GETFD), -1);
+
+        // Sizes must match, as for named segments
+        EXPECT_THROW(shared_memory(memfd, shmem.fd(), g_size + 1),
+                     std::runtime_error);
+    }
+
+    EXPECT_THROW(shared_memory(memfd, -1, g_size), std::runtime_error);
+    EXPECT_THROW(shared_memory(memfd, "", g_size), std::length_error);
+}
+
+TEST(shared_memory, memfd_huge_pages_or_fallback) {
+    using cpptools::memfd;
+
+    // Either we get huge pages, or a normal segment and a reason why not
+    cpptools::shared_memory_options options;
+    options.pages = cpptools::page_size::huge_2mb;
+    shared_memory shmem(memfd, g_valid_name, g_size, options);
+    if (shmem.huge_pages()) {
+        EXPECT_EQ(shmem.page_bytes(), size_t{2} << 20);
+        EXPECT_TRUE(shmem.fallback_reason().empty());
+    } else {
+        EXPECT_EQ(shmem.page_bytes(), size_t(sysconf(_SC_PAGESIZE)));
+        EXPECT_FALSE(shmem.fallback_reason().empty());
+    }
+
+    // Attaching picks the page size up from the segment
+    shared_memory attached(memfd, shmem.fd(), g_size);
+    EXPECT_EQ(attached.huge_pages(), shmem.huge_pages());
+    EXPECT_EQ(attached.page_bytes(), shmem.page_bytes());
+    EXPECT_EQ(attached.size(), g_size);
+}
+
+TEST(shared_memory, memfd_inherited_by_child) {
+    using cpptools::memfd;
+
+    shared_memory shmem(memfd, g_valid_name, g_size);
+    auto *words = reinterpret_cast<uint64_t *>(shmem.data());
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        {
+            shared_memory attached(memfd, shmem.fd(), g_size);
+            reinterpret_cast<uint64_t *>(attached.data())[0] = 42;
+        }
+        _exit(0);
+    }
+
+    int status{0};
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(words[0], 42);
+    EXPECT_EQ(shmem.reference_count(), 1);
+}
+
+TEST(shared_memory, memfd_sent_over_socket) {
+    using cpptools::memfd;
+
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+
+    // The child has no access to the segment until it receives it
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        close(sockets[0]);
+        int failures{0};
+        {
+            const int fd = cpptools::receive_fd(sockets[1]);
+            shared_memory attached(memfd, fd, g_size);
+            close(fd);
+
+            auto *words = reinterpret_cast<uint64_t *>(attached.data());
+            failures += words[0] != 7;
+            words[1] = 42;
+        }
+        close(sockets[1]);
+        _exit(failures);
+    }
+    close(sockets[1]);
+
+    shared_memory shmem(memfd, g_valid_name, g_size);
+    auto *words = reinterpret_cast<uint64_t *>(shmem.data());
+    words[0] = 7;
+    cpptools::send_fd(sockets[0], shmem.fd());
+
+    int status{0};
+    waitpid(pid, &status, 0);
+    close(sockets[0]);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(words[1], 42);
+
+    // Nothing to receive from a closed socket
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    close(sockets[0]);
+    EXPECT_THROW(cpptools::receive_fd(sockets[1]), std::runtime_error);
+    close(sockets[1]);
+    EXPECT_THROW(cpptools::send_fd(-1, shmem.fd()), std::system_error);
+}
+
+TEST(shared_memory, memfd_outlives_creator) {
+    using cpptools::memfd;
+
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+
+    // Send, then go away before the peer attaches
+    {
+        shared_memory shmem(memfd, g_valid_name, g_size);
+        reinterpret_cast<uint64_t *>(shmem.data())[0] = 7;
+        cpptools::send_fd(sockets[0], shmem.fd());
+    }
+
+    // The descriptor in flight kept the segment alive
+    const int fd = cpptools::receive_fd(sockets[1]);
+    close(sockets[0]);
+    close(sockets[1]);
+    shared_memory attached(memfd, fd, g_size);
+    close(fd);
+    EXPECT_EQ(reinterpret_cast<uint64_t *>(attached.data())[0], 7);
+    EXPECT_EQ(attached.reference_count(), 1);
+}
+
+TEST(shared_memory, memfd_seals_and_growth) {
+    using cpptools::memfd;
+
+    cpptools::shared_memory_options options;
+    options.max_size = 4 * g_size;
+    shared_memory shmem(memfd, g_valid_name, g_size, options);
+    shared_memory attached(memfd, shmem.fd(), g_size, options);
+
+    // Grows like a named segment
+    EXPECT_TRUE(shmem.grow(2 * g_size));
+    EXPECT_TRUE(attached.refresh());
+    EXPECT_EQ(attached.size(), 2 * g_size);
+
+    // Until sealed
+    EXPECT_EQ(shmem.seals(), 0);
+    shmem.seal(F_SEAL_SHRINK | F_SEAL_GROW);
+    EXPECT_EQ(shmem.seals(), F_SEAL_SHRINK | F_SEAL_GROW);
+    EXPECT_EQ(attached.seals(), F_SEAL_SHRINK | F_SEAL_GROW);
+    EXPECT_THROW(shmem.grow(4 * g_size), std::runtime_error);
+    EXPECT_EQ(ftruncate(shmem.fd(), 0), -1);
+
+    // The failed grow() let go of the segment
+    shmem.seal(F_SEAL_SEAL);
+    EXPECT_THROW(shmem.seal(F_SEAL_WRITE), std::system_error);
+    EXPECT_EQ(shmem.size(), 2 * g_size);
+    EXPECT_THROW(attached.grow(4 * g_size), std::runtime_error);
+
+    // Named segments can't be sealed
+    shared_memory named(g_valid_name, g_size);
+    EXPECT_FALSE(named.anonymous());
+    EXPECT_EQ(named.seals(), F_SEAL_SEAL);
+    EXPECT_THROW(named.seal(F_SEAL_GROW), std::system_error);
+}
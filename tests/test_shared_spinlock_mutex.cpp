@@ -0,0 +1,105 @@
+#include "cpptools/shared_spinlock_mutex.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using cpptools::shared_spinlock_mutex;
+
+TEST(shared_spinlock_mutex, constructor) {
+    ASSERT_NO_FATAL_FAILURE(shared_spinlock_mutex{});
+}
+
+TEST(shared_spinlock_mutex, exclusive) {
+    shared_spinlock_mutex m;
+
+    // Writer excludes other writers and readers
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+    EXPECT_FALSE(m.try_lock_shared());
+
+    m.unlock();
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(shared_spinlock_mutex, shared) {
+    shared_spinlock_mutex m;
+
+    // Multiple readers at once
+    EXPECT_TRUE(m.try_lock_shared());
+    EXPECT_TRUE(m.try_lock_shared());
+
+    // Readers exclude writers
+    EXPECT_FALSE(m.try_lock());
+
+    m.unlock_shared();
+    EXPECT_FALSE(m.try_lock());
+    m.unlock_shared();
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(shared_spinlock_mutex, std_lock_types) {
+    shared_spinlock_mutex m;
+
+    {
+        std::shared_lock l1(m);
+        std::shared_lock l2(m);
+        EXPECT_FALSE(m.try_lock());
+    }
+
+    {
+        std::scoped_lock l(m);
+        EXPECT_FALSE(m.try_lock_shared());
+    }
+
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(shared_spinlock_mutex, readers_and_writers) {
+    shared_spinlock_mutex m;
+
+    // Writers keep two values equal; readers must never see them differ
+    constexpr int num_readers = 3;
+    constexpr int num_writes = 5000;
+    int a{0};
+    int b{0};
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                std::shared_lock l(m);
+                if (a != b) {
+                    torn.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        for (int i = 0; i < num_writes; ++i) {
+            std::scoped_lock l(m);
+            ++a;
+            ++b;
+        }
+        done.store(true);
+    });
+
+    writer.join();
+    for (auto &t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(a, num_writes);
+    EXPECT_EQ(b, num_writes);
+}
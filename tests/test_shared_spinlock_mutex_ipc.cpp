@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <shared_mutex>
+#include <string>
+
+#include "cpptools/shared_spinlock_mutex_ipc.hpp"
+
+using cpptools::shared_spinlock_mutex_ipc;
+
+const std::string g_name = "/testing";
+
+// Exclusive locking is covered with the other IPC mutexes in test_mutex_ipc
+TEST(shared_spinlock_mutex_ipc, shared_lock) {
+    shared_spinlock_mutex_ipc lock1(g_name);
+
+    {
+        shared_spinlock_mutex_ipc lock2(g_name);
+        EXPECT_EQ(lock2.reference_count(), 2);
+
+        // Shared through both handles
+        std::shared_lock l1(lock1);
+        std::shared_lock l2(lock2);
+        EXPECT_FALSE(lock2.try_lock());
+    }
+
+    // Exclusive through one handle blocks the other
+    EXPECT_TRUE(lock1.try_lock());
+    {
+        shared_spinlock_mutex_ipc lock2(g_name);
+        EXPECT_FALSE(lock2.try_lock_shared());
+    }
+    EXPECT_NO_THROW(lock1.unlock());
+}
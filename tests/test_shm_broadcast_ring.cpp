@@ -0,0 +1,192 @@
+#include "cpptools/shm_broadcast_ring.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using cpptools::broadcast_status;
+
+using ring_t = cpptools::shm_broadcast_ring<1024>;
+
+static bool publish(ring_t &ring, std::string_view msg) {
+    return ring.publish(std::as_bytes(std::span(msg)));
+}
+
+// Reads the next message into out, if there is one
+static broadcast_status read(ring_t &ring, std::string &out) {
+    return ring.read([&](std::span<const std::byte> msg) {
+        out.assign(reinterpret_cast<const char *>(msg.data()), msg.size());
+    });
+}
+
+TEST(shm_broadcast_ring, publish_read) {
+    ring_t writer("/test_shm_broadcast_ring");
+    ring_t reader("/test_shm_broadcast_ring");
+
+    std::string msg;
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+
+    EXPECT_TRUE(publish(writer, "a"));
+    EXPECT_TRUE(publish(writer, ""));
+    EXPECT_TRUE(publish(writer, "seventeen bytes!!"));
+    EXPECT_GT(reader.lag(), 0);
+
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "a");
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "");
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "seventeen bytes!!");
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+    EXPECT_EQ(reader.lag(), 0);
+    EXPECT_EQ(reader.overruns(), 0);
+
+    // Written in place
+    auto buffer = writer.prepare(3);
+    ASSERT_EQ(buffer.size(), 3);
+    std::memcpy(buffer.data(), "xyz", 3);
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+    writer.commit();
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "xyz");
+}
+
+TEST(shm_broadcast_ring, late_joiner_starts_at_latest) {
+    ring_t writer("/test_shm_broadcast_ring");
+    EXPECT_TRUE(publish(writer, "old"));
+
+    ring_t reader("/test_shm_broadcast_ring");
+    std::string msg;
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+
+    EXPECT_TRUE(publish(writer, "new"));
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "new");
+}
+
+TEST(shm_broadcast_ring, oversized_message) {
+    ring_t writer("/test_shm_broadcast_ring");
+    const std::string msg(ring_t::max_message_size() + 1, 'x');
+    EXPECT_FALSE(publish(writer, msg));
+    EXPECT_TRUE(writer.prepare(msg.size()).empty());
+    EXPECT_TRUE(publish(writer, std::string_view(msg).substr(1)));
+}
+
+TEST(shm_broadcast_ring, wrap_around) {
+    ring_t writer("/test_shm_broadcast_ring");
+    ring_t reader("/test_shm_broadcast_ring");
+
+    // Sizes that don't divide the ring, so records get padded out at the
+    // end; the reader keeps up and must see every message
+    std::string msg;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string sent(i % 97, static_cast<char>('a' + i % 26));
+        ASSERT_TRUE(publish(writer, sent));
+        ASSERT_EQ(read(reader, msg), broadcast_status::ok);
+        ASSERT_EQ(msg, sent);
+    }
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+    EXPECT_EQ(reader.overruns(), 0);
+}
+
+TEST(shm_broadcast_ring, overrun) {
+    ring_t writer("/test_shm_broadcast_ring");
+    ring_t reader("/test_shm_broadcast_ring");
+
+    // Lap the reader
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(publish(writer, std::to_string(i)));
+    }
+
+    std::string msg;
+    EXPECT_EQ(read(reader, msg), broadcast_status::overrun);
+    EXPECT_EQ(reader.overruns(), 1);
+    EXPECT_EQ(reader.lag(), 0);
+    EXPECT_EQ(read(reader, msg), broadcast_status::empty);
+
+    // Caught up with the latest
+    EXPECT_TRUE(publish(writer, "next"));
+    EXPECT_EQ(read(reader, msg), broadcast_status::ok);
+    EXPECT_EQ(msg, "next");
+
+    // Overwritten while being read
+    EXPECT_TRUE(publish(writer, "slow"));
+    const auto status = reader.read([&](std::span<const std::byte>) {
+        for (int i = 0; i < 100; ++i) {
+            publish(writer, std::to_string(i));
+        }
+    });
+    EXPECT_EQ(status, broadcast_status::overrun);
+    EXPECT_EQ(reader.overruns(), 2);
+}
+
+TEST(shm_broadcast_ring, across_processes) {
+    static constexpr uint64_t MESSAGES = 100000;
+
+    // Created here, so that the reader is attached before anything is sent
+    ring_t reader("/test_shm_broadcast_ring");
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        {
+            ring_t writer("/test_shm_broadcast_ring");
+            for (uint64_t n = 1; n <= MESSAGES; ++n) {
+                // Varying lengths, each filled with copies of n
+                auto buffer = writer.prepare(8 * (n % 8 + 1));
+                for (size_t i = 0; i < buffer.size(); i += 8) {
+                    std::memcpy(&buffer[i], &n, 8);
+                }
+                writer.commit();
+                // Give the reader a chance on a single core
+                if (n % 8 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        _exit(0);
+    }
+
+    // Messages must arrive in order and whole, whatever gets overrun
+    uint64_t last{0};
+    uint64_t received{0};
+    uint64_t torn{0};
+    uint64_t out_of_order{0};
+    int status{0};
+    auto consume = [&] {
+        uint64_t n{0};
+        bool whole{true};
+        const auto result = reader.read([&](std::span<const std::byte> msg) {
+            std::memcpy(&n, msg.data(), 8);
+            for (size_t i = 8; i < msg.size(); i += 8) {
+                whole &= std::memcmp(&msg[i], &n, 8) == 0;
+            }
+            whole &= msg.size() == 8 * (n % 8 + 1);
+        });
+        if (result == broadcast_status::ok) {
+            torn += !whole;
+            out_of_order += n <= last;
+            last = n;
+            ++received;
+        }
+        return result;
+    };
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        consume();
+    }
+    while (consume() != broadcast_status::empty);
+
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(out_of_order, 0);
+    EXPECT_GT(received, 0);
+    EXPECT_LE(last, MESSAGES);
+}
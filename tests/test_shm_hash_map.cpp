@@ -0,0 +1,248 @@
+#include "cpptools/shm_hash_map.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "cpptools/macros.hpp"
+#include "cpptools/shared_memory.hpp"
+
+using cpptools::lookup_status;
+using cpptools::shm_hash_map;
+
+const char *g_name = "/test_shm_hash_map";
+
+// Sends every key to the same home group, so lookups have to probe
+struct collide {
+    size_t operator()(uint64_t) const noexcept { return 0; }
+};
+
+// Value whose words must all agree, to catch torn reads
+struct record {
+    uint64_t words[8];
+
+    static record of(uint64_t v) {
+        record r;
+        for (uint64_t &w : r.words) {
+            w = v;
+        }
+        return r;
+    }
+    bool consistent() const {
+        for (const uint64_t w : words) {
+            if (w != words[0]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+TEST(shm_hash_map, insert_find_erase) {
+    shm_hash_map<uint64_t, uint64_t, 1024> map(g_name);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.capacity(), 1024);
+    EXPECT_EQ(map.find(1), std::nullopt);
+
+    for (uint64_t k = 0; k < 500; ++k) {
+        ASSERT_TRUE(map.insert_or_assign(k, k * 10));
+    }
+    EXPECT_EQ(map.size(), 500);
+    for (uint64_t k = 0; k < 500; ++k) {
+        ASSERT_EQ(map.find(k), k * 10);
+    }
+    EXPECT_FALSE(map.contains(500));
+
+    // Overwrite
+    EXPECT_TRUE(map.insert_or_assign(7, 1));
+    EXPECT_EQ(map.find(7), 1);
+    EXPECT_EQ(map.size(), 500);
+
+    EXPECT_TRUE(map.erase(7));
+    EXPECT_FALSE(map.erase(7));
+    EXPECT_FALSE(map.contains(7));
+    EXPECT_EQ(map.size(), 499);
+}
+
+// Key with no default constructor
+struct id {
+    explicit id(uint64_t v) : value(v) {}
+    bool operator==(const id &) const = default;
+    uint64_t value;
+};
+
+struct id_hash {
+    size_t operator()(const id &k) const noexcept { return k.value; }
+};
+
+TEST(shm_hash_map, keys_need_not_be_default_constructible) {
+    shm_hash_map<id, id, 64, id_hash> map(g_name);
+    EXPECT_TRUE(map.insert_or_assign(id(1), id(10)));
+    EXPECT_EQ(map.find(id(1)), id(10));
+
+    id value(0);
+    EXPECT_EQ(map.try_find(id(1), value), lookup_status::found);
+    EXPECT_EQ(value, id(10));
+    EXPECT_EQ(map.try_find(id(2), value), lookup_status::missing);
+    EXPECT_EQ(value, id(10));
+}
+
+TEST(shm_hash_map, try_find_gives_up_on_a_stuck_writer) {
+    shm_hash_map<uint64_t, uint64_t, 16> map(g_name);
+    ASSERT_TRUE(map.insert_or_assign(1, 10));
+
+    // Mirrors the map's layout: with 16 slots there's one group, whose
+    // version comes first. Leave it odd, as a writer that died in the middle
+    // of a write would.
+    struct alignas(CPPTOOLS_CACHELINE_SIZE) group {
+        std::atomic<uint32_t> version;
+        uint32_t locks[2];
+        uint8_t ctrl[16];
+        uint64_t slots[16][2];
+    };
+    struct layout {
+        alignas(CPPTOOLS_CACHELINE_SIZE) size_t size;
+        group g;
+    };
+    cpptools::shared_memory raw(g_name, sizeof(layout));
+    std::atomic<uint32_t> *version = &raw.as_struct<layout>()->g.version;
+    version->fetch_add(1);
+
+    uint64_t value{0};
+    EXPECT_EQ(map.try_find(1, value), lookup_status::busy);
+    EXPECT_EQ(map.try_find(1, value, 1), lookup_status::busy);
+    EXPECT_EQ(value, 0);
+
+    version->fetch_add(1);
+    EXPECT_EQ(map.try_find(1, value), lookup_status::found);
+    EXPECT_EQ(value, 10);
+}
+
+TEST(shm_hash_map, probing_and_full) {
+    shm_hash_map<uint64_t, uint64_t, 64, collide> map(g_name);
+
+    // All keys start in one group and spill over into the next ones
+    for (uint64_t k = 0; k < 64; ++k) {
+        ASSERT_TRUE(map.insert_or_assign(k, k));
+    }
+    EXPECT_FALSE(map.insert_or_assign(64, 64));
+    EXPECT_EQ(map.size(), 64);
+    for (uint64_t k = 0; k < 64; ++k) {
+        ASSERT_EQ(map.find(k), k);
+    }
+    EXPECT_FALSE(map.contains(64));
+
+    // Erasing from the full first group leaves a tombstone, so keys in
+    // later groups are still found and the slot is reused
+    EXPECT_TRUE(map.erase(3));
+    EXPECT_EQ(map.find(40), 40);
+    EXPECT_TRUE(map.insert_or_assign(100, 100));
+    EXPECT_EQ(map.find(100), 100);
+    EXPECT_EQ(map.find(63), 63);
+}
+
+TEST(shm_hash_map, concurrent_readers_and_writers) {
+    shm_hash_map<uint64_t, record, 4096> map(g_name);
+    constexpr uint64_t KEYS = 1024;
+    for (uint64_t k = 0; k < KEYS; ++k) {
+        map.insert_or_assign(k, record::of(k));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> missing{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 2; ++r) {
+        threads.emplace_back([&] {
+            uint64_t k{0};
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto value = map.find(k++ % KEYS);
+                if (!value) {
+                    missing.fetch_add(1);
+                } else if (!value->consistent()) {
+                    torn.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (uint64_t w = 0; w < 2; ++w) {
+        threads.emplace_back([&map, w] {
+            for (uint64_t i = 0; i < 20000; ++i) {
+                const uint64_t k = (i * 2 + w) % KEYS;
+                map.insert_or_assign(k, record::of(i));
+            }
+        });
+    }
+
+    threads[2].join();
+    threads[3].join();
+    stop = true;
+    threads[0].join();
+    threads[1].join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(missing.load(), 0);
+    EXPECT_EQ(map.size(), KEYS);
+}
+
+TEST(shm_hash_map, concurrent_inserts_of_same_keys) {
+    shm_hash_map<uint64_t, uint64_t, 1024, collide> map(g_name);
+
+    // Racing writers of the same keys never add a key twice
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&map] {
+            for (uint64_t k = 0; k < 200; ++k) {
+                map.insert_or_assign(k, k);
+                if (k % 3 == 0) {
+                    map.erase(k);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    uint64_t found{0};
+    for (uint64_t k = 0; k < 200; ++k) {
+        found += map.contains(k);
+    }
+    EXPECT_EQ(map.size(), found);
+}
+
+TEST(shm_hash_map, shared_across_processes) {
+    using map_t = shm_hash_map<uint64_t, uint64_t, 256>;
+    map_t map(g_name);
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        bool ok{true};
+        {
+            map_t writer(g_name);
+            for (uint64_t k = 1; k <= 100; ++k) {
+                ok = ok && writer.insert_or_assign(k, k * k);
+            }
+        }
+        _exit(ok ? 0 : 1);
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    EXPECT_EQ(map.size(), 100);
+    for (uint64_t k = 1; k <= 100; ++k) {
+        ASSERT_EQ(map.find(k), k * k);
+    }
+}
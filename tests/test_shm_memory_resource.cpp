@@ -0,0 +1,236 @@
+#include "cpptools/shm_memory_resource.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using cpptools::shm_memory_resource;
+
+const char *g_name = "/test_shm_memory_resource";
+const size_t g_size = 4 * 1024 * 1024;  // 4 MiB
+
+TEST(shm_memory_resource, block_size) {
+    EXPECT_EQ(shm_memory_resource::block_size(0, 8), 16);
+    EXPECT_EQ(shm_memory_resource::block_size(1, 8), 16);
+    EXPECT_EQ(shm_memory_resource::block_size(17, 8), 32);
+    EXPECT_EQ(shm_memory_resource::block_size(128, 8), 128);
+    EXPECT_EQ(shm_memory_resource::block_size(129, 8), 160);
+    EXPECT_EQ(shm_memory_resource::block_size(256, 8), 256);
+    EXPECT_EQ(shm_memory_resource::block_size(257, 8), 320);
+    EXPECT_EQ(shm_memory_resource::block_size(5000, 8), 5120);
+
+    // Over-aligned requests use power-of-two classes
+    EXPECT_EQ(shm_memory_resource::block_size(100, 64), 128);
+    EXPECT_EQ(shm_memory_resource::block_size(10, 4096), 4096);
+
+    // Unsatisfiable
+    EXPECT_EQ(shm_memory_resource::block_size(1, 8192), 0);
+    EXPECT_EQ(shm_memory_resource::block_size(
+                  shm_memory_resource::MAX_HEAP_SIZE + 1, 8),
+              0);
+
+    // Rounding never loses more than 25% above 128 bytes
+    for (size_t bytes = 129; bytes < (1 << 20); bytes += 37) {
+        const size_t block = shm_memory_resource::block_size(bytes, 8);
+        ASSERT_GE(block, bytes);
+        ASSERT_LE(block - bytes, bytes / 4);
+    }
+}
+
+TEST(shm_memory_resource, too_small) {
+    EXPECT_THROW(shm_memory_resource(g_name, 4096), std::length_error);
+}
+
+TEST(shm_memory_resource, allocate_and_reuse) {
+    shm_memory_resource res(g_name, g_size);
+    EXPECT_GT(res.capacity(), g_size - 16 * 1024);
+
+    void *p = res.allocate(100);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 16, 0);
+    std::memset(p, 0xab, 100);
+
+    auto stats = res.stats();
+    EXPECT_EQ(stats.blocks, 1);
+    EXPECT_EQ(stats.requested, 100);
+    EXPECT_EQ(stats.in_use, 112);
+    EXPECT_EQ(stats.reserved, 112);
+    EXPECT_EQ(stats.cached, 0);
+
+    // A freed block goes back to its class and is handed out again
+    res.deallocate(p, 100);
+    stats = res.stats();
+    EXPECT_EQ(stats.blocks, 0);
+    EXPECT_EQ(stats.requested, 0);
+    EXPECT_EQ(stats.cached, 112);
+    EXPECT_GT(stats.external_fragmentation(), 0.0);
+
+    EXPECT_EQ(res.allocate(97), p);
+    EXPECT_EQ(res.stats().reserved, 112);
+    res.deallocate(p, 97);
+}
+
+TEST(shm_memory_resource, alignment) {
+    shm_memory_resource res(g_name, g_size);
+
+    std::vector<std::pair<void *, size_t>> blocks;
+    for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+        for (const size_t bytes : {size_t{1}, size_t{24}, size_t{5000}}) {
+            void *p = res.allocate(bytes, alignment);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignment, 0)
+                << bytes << " bytes aligned to " << alignment;
+            res.deallocate(p, bytes, alignment);
+            blocks.emplace_back(res.allocate(bytes, alignment), alignment);
+            EXPECT_EQ(
+                reinterpret_cast<uintptr_t>(blocks.back().first) % alignment,
+                0);
+        }
+    }
+
+    EXPECT_THROW((void)res.allocate(1, 8192), std::bad_alloc);
+    EXPECT_EQ(res.stats().failed, 1);
+}
+
+TEST(shm_memory_resource, exhaustion) {
+    shm_memory_resource res(g_name, g_size);
+
+    EXPECT_THROW((void)res.allocate(g_size), std::bad_alloc);
+
+    std::vector<void *> blocks;
+    try {
+        while (true) {
+            blocks.push_back(res.allocate(64 * 1024));
+        }
+    } catch (const std::bad_alloc &) {
+    }
+    EXPECT_FALSE(blocks.empty());
+    EXPECT_EQ(res.stats().failed, 2);
+    EXPECT_GT(res.stats().utilization(), 0.9);
+
+    // Freed blocks make room again
+    res.deallocate(blocks.back(), 64 * 1024);
+    blocks.back() = res.allocate(64 * 1024);
+
+    for (void *p : blocks) {
+        res.deallocate(p, 64 * 1024);
+    }
+    EXPECT_EQ(res.stats().blocks, 0);
+}
+
+TEST(shm_memory_resource, pmr_containers) {
+    shm_memory_resource res(g_name, g_size);
+
+    {
+        std::pmr::vector<std::pmr::string> v(&res);
+        for (int i = 0; i < 1000; ++i) {
+            v.emplace_back(std::string(i % 100 + 20, 'x'));
+        }
+        EXPECT_EQ(std::string_view(v[999]), std::string(119, 'x'));
+        EXPECT_GT(res.stats().blocks, 1000);
+        EXPECT_GT(res.stats().internal_fragmentation(), 0.0);
+        EXPECT_LT(res.stats().internal_fragmentation(), 0.25);
+    }
+
+    const auto stats = res.stats();
+    EXPECT_EQ(stats.blocks, 0);
+    EXPECT_EQ(stats.requested, 0);
+    EXPECT_EQ(stats.in_use, 0);
+    EXPECT_EQ(stats.cached + stats.padding, stats.reserved);
+}
+
+TEST(shm_memory_resource, threads) {
+    shm_memory_resource res(g_name, g_size);
+
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&res, t] {
+            std::mt19937 rng(t);
+            std::vector<std::pair<uint64_t *, size_t>> held;
+            for (int i = 0; i < ROUNDS; ++i) {
+                if (held.size() < 64 && (held.empty() || rng() % 2 == 0)) {
+                    const size_t n = rng() % 64 + 1;
+                    auto *p = static_cast<uint64_t *>(
+                        res.allocate(n * sizeof(uint64_t)));
+                    for (size_t j = 0; j < n; ++j) {
+                        p[j] = (uint64_t(t) << 32) | i;
+                    }
+                    held.emplace_back(p, n);
+                } else {
+                    const size_t k = rng() % held.size();
+                    auto [p, n] = held[k];
+                    // Nobody else wrote to our block while we held it
+                    for (size_t j = 1; j < n; ++j) {
+                        ASSERT_EQ(p[j], p[0]);
+                    }
+                    res.deallocate(p, n * sizeof(uint64_t));
+                    held[k] = held.back();
+                    held.pop_back();
+                }
+            }
+            for (auto [p, n] : held) {
+                res.deallocate(p, n * sizeof(uint64_t));
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    const auto stats = res.stats();
+    EXPECT_EQ(stats.blocks, 0);
+    EXPECT_EQ(stats.requested, 0);
+    // Blocks were reused rather than carved again
+    EXPECT_LT(stats.reserved, THREADS * 64 * 64 * sizeof(uint64_t));
+}
+
+TEST(shm_memory_resource, cross_process) {
+    shm_memory_resource res(g_name, g_size);
+
+    // The child attaches at its own address, allocates a string and hands
+    // it back by offset
+    auto *slot = static_cast<size_t *>(res.allocate(sizeof(size_t)));
+    const size_t slot_offset = res.offset_of(slot);
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        bool ok{false};
+        {
+            shm_memory_resource other(g_name, g_size);
+            ok = other.reference_count() == 2;
+            char *str = static_cast<char *>(other.allocate(6));
+            std::memcpy(str, "hello", 6);
+            *static_cast<size_t *>(other.at(slot_offset)) =
+                other.offset_of(str);
+        }
+        _exit(ok ? 0 : 1);
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // Freed here, reused by the next allocation of that class
+    char *str = static_cast<char *>(res.at(*slot));
+    EXPECT_STREQ(str, "hello");
+    EXPECT_EQ(res.stats().blocks, 2);
+    res.deallocate(str, 6);
+    EXPECT_EQ(res.allocate(6), str);
+}
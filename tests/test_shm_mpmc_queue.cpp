@@ -0,0 +1,168 @@
+#include "cpptools/shm_mpmc_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "cpptools/shared_memory.hpp"
+
+using queue_t = cpptools::shm_mpmc_queue<uint64_t, 8>;
+
+const std::string g_name = "/testing";
+const std::string g_sums_name = "/testing_sums";
+
+TEST(shm_mpmc_queue, constructor) {
+    queue_t q(g_name);
+    EXPECT_EQ(q.name(), g_name);
+    EXPECT_EQ(q.reference_count(), 1);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.capacity(), 8u);
+}
+
+TEST(shm_mpmc_queue, push_pop) {
+    queue_t q(g_name);
+
+    uint64_t item{0};
+    EXPECT_FALSE(q.try_pop(item));
+
+    // Fill across several laps of the ring
+    for (int lap = 0; lap < 3; ++lap) {
+        for (uint64_t i = 0; i < q.capacity(); ++i) {
+            EXPECT_TRUE(q.try_push(i));
+        }
+        EXPECT_FALSE(q.try_push(99));
+        EXPECT_EQ(q.size(), q.capacity());
+
+        for (uint64_t i = 0; i < q.capacity(); ++i) {
+            EXPECT_TRUE(q.try_pop(item));
+            EXPECT_EQ(item, i);
+        }
+        EXPECT_FALSE(q.try_pop(item));
+    }
+}
+
+TEST(shm_mpmc_queue, batch) {
+    queue_t q(g_name);
+
+    // Offset the cursors so that batches wrap around the ring
+    uint64_t item{0};
+    for (uint64_t i = 0; i < 5; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+        ASSERT_TRUE(q.try_pop(item));
+    }
+
+    std::array<uint64_t, 10> in{};
+    std::iota(in.begin(), in.end(), 100);
+    EXPECT_EQ(q.push(in), 8u);
+    EXPECT_EQ(q.push(in), 0u);
+
+    std::array<uint64_t, 3> out{};
+    EXPECT_EQ(q.pop_wait(out), 3u);
+    EXPECT_EQ(out[0], 100u);
+    EXPECT_EQ(out[2], 102u);
+
+    std::array<uint64_t, 10> rest{};
+    EXPECT_EQ(q.pop(rest), 5u);
+    EXPECT_EQ(rest[4], 107u);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(shm_mpmc_queue, blocking) {
+    queue_t q(g_name);
+
+    q.push_wait(uint64_t{5});
+    uint64_t item{0};
+    q.pop_wait(item);
+    EXPECT_EQ(item, 5u);
+}
+
+TEST(shm_mpmc_queue, multi_process) {
+    constexpr int num_producers = 3;
+    constexpr int num_consumers = 2;
+    constexpr uint64_t items_per_producer = 20000;
+
+    queue_t q(g_name);
+
+    // Per-consumer sums and counts of popped items, then the total popped
+    constexpr size_t sums_size = sizeof(uint64_t) * (2 * num_consumers + 1);
+    cpptools::shared_memory sums_mem(g_sums_name, sums_size);
+    std::span<uint64_t> sums = sums_mem.as_span<uint64_t>();
+
+    std::vector<pid_t> pids;
+    for (int p = 0; p < num_producers; ++p) {
+        const pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            {
+                queue_t producer(g_name);
+                for (uint64_t i = 1; i <= items_per_producer; ++i) {
+                    while (!producer.try_push(i)) {
+                        sched_yield();
+                    }
+                }
+            }
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+
+    constexpr uint64_t total = num_producers * items_per_producer;
+    for (int c = 0; c < num_consumers; ++c) {
+        const pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            {
+                queue_t consumer(g_name);
+                cpptools::shared_memory mem(g_sums_name, sums_size);
+                std::atomic_ref<uint64_t> popped_total(
+                    mem.as_span<uint64_t>()[2 * num_consumers]);
+
+                std::array<uint64_t, 4> batch{};
+                uint64_t sum{0};
+                uint64_t count{0};
+                while (popped_total.load() < total) {
+                    const size_t n = consumer.pop(batch);
+                    if (n == 0) {
+                        sched_yield();
+                        continue;
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        sum += batch[i];
+                    }
+                    count += n;
+                    popped_total.fetch_add(n);
+                }
+                mem.as_span<uint64_t>()[c] = sum;
+                mem.as_span<uint64_t>()[num_consumers + c] = count;
+            }
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+
+    for (pid_t pid : pids) {
+        int status{0};
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status));
+    }
+
+    // Every item popped exactly once
+    uint64_t sum{0};
+    uint64_t count{0};
+    for (int c = 0; c < num_consumers; ++c) {
+        sum += sums[c];
+        count += sums[num_consumers + c];
+    }
+    EXPECT_EQ(count, total);
+    EXPECT_EQ(sum, num_producers * items_per_producer *
+                       (items_per_producer + 1) / 2);
+    EXPECT_TRUE(q.empty());
+}
@@ -0,0 +1,147 @@
+#include "cpptools/shm_spsc_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <string>
+
+using queue_t = cpptools::shm_spsc_queue<uint64_t, 8>;
+
+const std::string g_name = "/testing";
+
+TEST(shm_spsc_queue, constructor) {
+    queue_t q(g_name);
+    EXPECT_EQ(q.name(), g_name);
+    EXPECT_EQ(q.reference_count(), 1);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.capacity(), 8u);
+}
+
+TEST(shm_spsc_queue, push_pop) {
+    queue_t q(g_name);
+
+    uint64_t item{0};
+    EXPECT_FALSE(q.try_pop(item));
+
+    // Fill
+    for (uint64_t i = 0; i < q.capacity(); ++i) {
+        EXPECT_TRUE(q.try_push(i));
+    }
+    EXPECT_FALSE(q.try_push(99));
+    EXPECT_EQ(q.size(), q.capacity());
+
+    // Drain in order
+    for (uint64_t i = 0; i < q.capacity(); ++i) {
+        EXPECT_TRUE(q.try_pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(q.try_pop(item));
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(shm_spsc_queue, batch_wraps_around) {
+    queue_t q(g_name);
+
+    // Offset head/tail so that batches straddle the end of the ring
+    uint64_t item{0};
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+        ASSERT_TRUE(q.try_pop(item));
+    }
+
+    std::array<uint64_t, 10> in{};
+    std::iota(in.begin(), in.end(), 100);
+
+    // Only 8 fit
+    EXPECT_EQ(q.push(in), 8u);
+    EXPECT_EQ(q.size(), 8u);
+
+    std::array<uint64_t, 10> out{};
+    EXPECT_EQ(q.pop(out), 8u);
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(out[i], in[i]);
+    }
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(shm_spsc_queue, claim_commit) {
+    queue_t q(g_name);
+
+    // Claim contiguous slots, fill in place, publish part of them
+    std::span<uint64_t> slots = q.claim_push(4);
+    ASSERT_EQ(slots.size(), 4u);
+    slots[0] = 7;
+    slots[1] = 8;
+    q.commit_push(2);
+    EXPECT_EQ(q.size(), 2u);
+
+    // Read in place
+    std::span<const uint64_t> filled = q.claim_pop(4);
+    ASSERT_EQ(filled.size(), 2u);
+    EXPECT_EQ(filled[0], 7u);
+    EXPECT_EQ(filled[1], 8u);
+    q.commit_pop(filled.size());
+    EXPECT_TRUE(q.empty());
+
+    // Claims never cross the end of the ring
+    EXPECT_EQ(q.claim_push(8).size(), 6u);
+}
+
+TEST(shm_spsc_queue, shared_between_instances) {
+    queue_t producer(g_name);
+    queue_t consumer(g_name);
+    EXPECT_EQ(producer.reference_count(), 2);
+
+    EXPECT_TRUE(producer.try_push(42));
+
+    uint64_t item{0};
+    EXPECT_TRUE(consumer.try_pop(item));
+    EXPECT_EQ(item, 42u);
+}
+
+TEST(shm_spsc_queue, cross_process) {
+    constexpr uint64_t num_items = 100000;
+
+    queue_t producer(g_name);
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // Child consumes and checks ordering
+        int ret{0};
+        {
+            queue_t consumer(g_name);
+            uint64_t expected{0};
+            std::array<uint64_t, 4> batch{};
+            while (expected < num_items) {
+                const size_t n = consumer.pop(batch);
+                if (n == 0) {
+                    sched_yield();
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    if (batch[i] != expected++) {
+                        ret = 1;
+                    }
+                }
+            }
+        }
+        _exit(ret);
+    }
+
+    for (uint64_t i = 0; i < num_items; ++i) {
+        while (!producer.try_push(i)) {
+            sched_yield();
+        }
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
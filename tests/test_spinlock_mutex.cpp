@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <mutex>
+#include <thread>
+#include <vector>
+
 using cpptools::spinlock_mutex;
 
 TEST(spinlock_mutex, constructor) { ASSERT_NO_FATAL_FAILURE(spinlock_mutex{}); }
@@ -38,3 +42,40 @@ TEST(spinlock_mutex, unlock) {
     m.unlock();
     EXPECT_TRUE(m.try_lock());
 }
+
+TEST(spinlock_mutex, backoff_limits) {
+    // Default limits
+    spinlock_mutex m1;
+    EXPECT_EQ(m1.limits().min_spins, cpptools::backoff_limits{}.min_spins);
+    EXPECT_EQ(m1.limits().max_spins, cpptools::backoff_limits{}.max_spins);
+
+    // Custom limits
+    spinlock_mutex m2({.min_spins = 1, .max_spins = 8});
+    EXPECT_EQ(m2.limits().min_spins, 1u);
+    EXPECT_EQ(m2.limits().max_spins, 8u);
+}
+
+TEST(spinlock_mutex, contended) {
+    spinlock_mutex m({.min_spins = 1, .max_spins = 16});
+
+    // Several threads increment a counter under the mutex
+    constexpr int num_threads = 4;
+    constexpr int num_iters = 10000;
+    int counter{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < num_iters; ++j) {
+                std::scoped_lock l(m);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // No increments lost
+    EXPECT_EQ(counter, num_threads * num_iters);
+}
@@ -1,12 +1,45 @@
 #include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <thread>
 
+#include "cpptools/shared_memory.hpp"
 #include "cpptools/spinlock_mutex_ipc.hpp"
 
+using cpptools::lock_status;
+using cpptools::shared_memory;
 using cpptools::spinlock_mutex_ipc;
 
 const std::string g_name = "/testing";
+const std::string g_flag_name = "/testing_flag";
+
+// Forks a child that takes the lock, raises the flag, and then runs
+// after_lock(). Children use the parent's mappings and never run
+// destructors, so reference counts stay as the parent sees them.
+template <typename F>
+pid_t fork_holder(spinlock_mutex_ipc &lock, std::atomic<int> &flag,
+                  F after_lock) {
+    flag = 0;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        lock.lock();
+        flag = 1;
+        after_lock();
+        _exit(0);
+    }
+
+    // Wait for the child to hold the lock
+    while (pid != -1 && flag == 0) {
+        std::this_thread::yield();
+    }
+    return pid;
+}
 
 TEST(spinlock_mutex_ipc, constructor) {
     ASSERT_NO_FATAL_FAILURE(spinlock_mutex_ipc{g_name});
@@ -48,3 +81,140 @@ TEST(spinlock_mutex_ipc, lock_unlock) {
     EXPECT_FALSE(lock1.try_lock());
     EXPECT_NO_THROW(lock1.unlock());
 }
+
+TEST(spinlock_mutex_ipc, owner) {
+    spinlock_mutex_ipc lock(g_name);
+    EXPECT_EQ(lock.owner(), 0);
+
+    EXPECT_EQ(lock.lock(), lock_status::acquired);
+    EXPECT_EQ(lock.owner(), gettid());
+    lock.unlock();
+    EXPECT_EQ(lock.owner(), 0);
+
+    // Works with std::scoped_lock
+    {
+        std::scoped_lock l(lock);
+        EXPECT_FALSE(lock.try_lock());
+    }
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST(spinlock_mutex_ipc, live_owner_not_recovered) {
+    spinlock_mutex_ipc lock(g_name);
+    shared_memory flag_mem(g_flag_name, sizeof(std::atomic<int>));
+    auto *flag = flag_mem.as_struct<std::atomic<int>>();
+
+    // Holder keeps the lock for longer than a few liveness checks
+    const pid_t pid = fork_holder(lock, *flag, [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        lock.unlock();
+    });
+    ASSERT_NE(pid, -1);
+
+    EXPECT_EQ(lock.lock(), lock_status::acquired);
+    lock.unlock();
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+}
+
+TEST(spinlock_mutex_ipc, recover_from_exited_owner) {
+    spinlock_mutex_ipc lock(g_name);
+    shared_memory flag_mem(g_flag_name, sizeof(std::atomic<int>));
+    auto *flag = flag_mem.as_struct<std::atomic<int>>();
+
+    // Holder exits without unlocking, and is reaped
+    const pid_t pid = fork_holder(lock, *flag, [] {});
+    ASSERT_NE(pid, -1);
+    ASSERT_EQ(waitpid(pid, nullptr, 0), pid);
+    EXPECT_EQ(lock.owner(), pid);
+
+    EXPECT_EQ(lock.lock(), lock_status::owner_dead);
+    EXPECT_EQ(lock.owner(), gettid());
+    lock.unlock();
+
+    // Back to normal
+    EXPECT_EQ(lock.lock(), lock_status::acquired);
+    lock.unlock();
+}
+
+TEST(spinlock_mutex_ipc, try_lock_leaves_recovery_to_lock) {
+    spinlock_mutex_ipc lock(g_name);
+    shared_memory flag_mem(g_flag_name, sizeof(std::atomic<int>));
+    auto *flag = flag_mem.as_struct<std::atomic<int>>();
+
+    // Holder is killed while it holds the lock
+    const pid_t pid = fork_holder(lock, *flag, [] { pause(); });
+    ASSERT_NE(pid, -1);
+    ASSERT_EQ(kill(pid, SIGKILL), 0);
+    ASSERT_EQ(waitpid(pid, nullptr, 0), pid);
+
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_EQ(lock.owner(), pid);
+
+    EXPECT_EQ(lock.lock(), lock_status::owner_dead);
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST(spinlock_mutex_ipc, recover_from_killed_owner) {
+    using clock = std::chrono::steady_clock;
+
+    spinlock_mutex_ipc lock(g_name);
+    shared_memory flag_mem(g_flag_name, sizeof(std::atomic<int>));
+    auto *flag = flag_mem.as_struct<std::atomic<int>>();
+
+    // Holder is killed while it holds the lock. Not reaped before we lock, so
+    // it's still a zombie when we first check on it.
+    const pid_t pid = fork_holder(lock, *flag, [] { pause(); });
+    ASSERT_NE(pid, -1);
+    ASSERT_EQ(kill(pid, SIGKILL), 0);
+
+    const auto start = clock::now();
+    EXPECT_EQ(lock.lock(), lock_status::owner_dead);
+    const auto latency = clock::now() - start;
+    lock.unlock();
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFSIGNALED(status));
+
+    // Recovery takes a few liveness checks at most
+    EXPECT_LT(latency, std::chrono::milliseconds(100));
+    RecordProperty(
+        "recovery_latency_us",
+        std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+TEST(spinlock_mutex_ipc, cross_process) {
+    constexpr int num_iters = 10000;
+
+    spinlock_mutex_ipc lock(g_name);
+    shared_memory counter_mem(g_flag_name, sizeof(int));
+    int *counter = counter_mem.as_struct<int>();
+    *counter = 0;
+
+    // Parent and child increment a shared counter under the lock
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        for (int i = 0; i < num_iters; ++i) {
+            std::scoped_lock l(lock);
+            ++*counter;
+        }
+        _exit(0);
+    }
+
+    for (int i = 0; i < num_iters; ++i) {
+        std::scoped_lock l(lock);
+        ++*counter;
+    }
+
+    int status{0};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(*counter, 2 * num_iters);
+}
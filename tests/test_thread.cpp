@@ -1,11 +1,22 @@
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
 
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <thread>
 #include <utility>
 
+#include "cpptools/cpu_topology.hpp"
 #include "cpptools/thread.hpp"
 
 using cpptools::thread;
+using cpptools::thread_attributes;
 
 TEST(thread, default_constructor) {
     EXPECT_NO_THROW(thread{});
@@ -75,6 +86,24 @@ TEST(thread, move_constructor) {
     EXPECT_FALSE(t2.joinable());
 }
 
+TEST(thread, get_id) {
+    EXPECT_EQ(thread{}.get_id(), std::thread::id());
+
+    std::atomic<std::thread::id> self{};
+    thread t([&self] { self = std::this_thread::get_id(); });
+    const std::thread::id id = t.get_id();
+    t.join();
+
+    EXPECT_EQ(id, self.load());
+    EXPECT_NE(id, std::this_thread::get_id());
+    EXPECT_EQ(t.get_id(), std::thread::id());
+}
+
+TEST(thread, hardware_concurrency) {
+    EXPECT_EQ(thread::hardware_concurrency(),
+              std::thread::hardware_concurrency());
+}
+
 TEST(thread, function_and_args_constructor) {
     int res{0};
     const auto f = [&res](int a, int b) { res = a + b; };
@@ -90,3 +119,233 @@ TEST(thread, function_and_args_constructor) {
     // Expected result
     EXPECT_EQ(res, 579);
 }
+
+TEST(thread, move_assignment) {
+    thread t1;
+    t1.set_core(0);
+    t1.set_name("abc");
+
+    int res{0};
+    thread t2([&res] { res = 1; });
+
+    // Join before overwriting a joinable thread
+    t2.join();
+    t2 = std::move(t1);
+
+    EXPECT_EQ(t1.core(), -1);
+    EXPECT_EQ(t1.name(), "");
+    EXPECT_EQ(t2.core(), 0);
+    EXPECT_EQ(t2.name(), "abc");
+    EXPECT_EQ(res, 1);
+}
+
+TEST(thread, set_name_applies_new_name) {
+    thread t;
+    EXPECT_TRUE(t.set_name("first"));
+    EXPECT_TRUE(t.set_name("second"));
+
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    EXPECT_STREQ(name, "second");
+}
+
+TEST(thread, latency_profile_default) {
+    // Without a profile, nothing is reported
+    thread t1([] {});
+    t1.join();
+    EXPECT_TRUE(t1.latency().ok());
+    EXPECT_EQ(t1.latency().stack_prefaulted, 0u);
+
+    // An empty profile changes nothing
+    thread t2(cpptools::latency_profile{}, [] {});
+    t2.join();
+    EXPECT_TRUE(t2.latency().ok());
+    EXPECT_EQ(t2.latency().policy, SCHED_OTHER);
+}
+
+TEST(thread, latency_profile_applied_before_body) {
+    cpptools::latency_profile profile;
+    profile.timer_slack_ns = 1000;
+    profile.stack_prefault = 256 * 1024;
+
+    // The body sees the profile in effect
+    long slack{-1};
+    thread t(
+        profile,
+        [&slack](int offset) {
+            slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0) + offset;
+        },
+        0);
+    t.join();
+
+    EXPECT_TRUE(t.latency().ok()) << t.latency().errors.front();
+    EXPECT_EQ(t.latency().timer_slack_ns, 1000);
+    EXPECT_EQ(slack, 1000);
+    EXPECT_EQ(t.latency().stack_prefaulted, 256u * 1024);
+    EXPECT_FALSE(t.latency().memory_locked);
+}
+
+TEST(thread, latency_profile_step_errors) {
+    cpptools::latency_profile profile;
+
+    // More stack than the thread has: clamped and reported
+    profile.stack_prefault = size_t{1} << 40;
+    // Real-time scheduling may not be permitted here
+    profile.set_scheduling = true;
+    profile.policy = SCHED_FIFO;
+    profile.priority = 1;
+
+    thread t(profile, [] {});
+    t.join();
+
+    const cpptools::latency_report &report = t.latency();
+    EXPECT_FALSE(report.ok());
+    EXPECT_LT(report.stack_prefaulted, profile.stack_prefault);
+    const bool fifo = report.policy == SCHED_FIFO;
+    EXPECT_EQ(report.errors.size(), fifo ? 1u : 2u);
+    if (fifo) {
+        EXPECT_EQ(report.priority, 1);
+    }
+}
+
+TEST(thread, latency_profile_lock_memory) {
+    cpptools::latency_profile profile;
+    profile.lock_memory = true;
+
+    thread t(profile, [] {});
+    t.join();
+
+    // Either locked, or the failure is reported
+    EXPECT_NE(t.latency().memory_locked, !t.latency().ok());
+    munlockall();
+}
+
+TEST(thread, latency_profile_strict) {
+    cpptools::cpu_topology topology;
+    if (!topology.isolated().empty() || !topology.nohz_full().empty()) {
+        GTEST_SKIP() << "system has isolated CPUs";
+    }
+
+    // The isolation check fails here, so the body must not run
+    cpptools::latency_profile profile;
+    profile.require_isolated = true;
+    profile.strict = true;
+
+    bool ran{false};
+    EXPECT_THROW(thread(profile, [&ran] { ran = true; }), std::runtime_error);
+    EXPECT_FALSE(ran);
+
+    // Not strict: runs anyway, with the failure reported
+    profile.strict = false;
+    thread t(profile, [&ran] { ran = true; });
+    t.join();
+    EXPECT_TRUE(ran);
+    EXPECT_FALSE(t.latency().isolated);
+    EXPECT_FALSE(t.latency().ok());
+}
+
+TEST(thread, attributes_applied_before_run) {
+    thread_attributes attributes;
+    attributes.cpus = {0};
+    attributes.name = "spawned";
+    attributes.stack_size = 1 << 20;
+    attributes.guard_size = 1 << 16;
+
+    // Read back from inside the thread, first thing
+    cpu_set_t cpus;
+    char name[16] = {};
+    size_t stack_size{0};
+    size_t guard_size{0};
+    thread t(attributes, [&] {
+        sched_getaffinity(0, sizeof(cpus), &cpus);
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+
+        pthread_attr_t attr;
+        pthread_getattr_np(pthread_self(), &attr);
+        pthread_attr_getstacksize(&attr, &stack_size);
+        pthread_attr_getguardsize(&attr, &guard_size);
+        pthread_attr_destroy(&attr);
+    });
+    EXPECT_TRUE(t.joinable());
+    EXPECT_EQ(t.name(), "spawned");
+    EXPECT_EQ(t.core(), 0);
+    t.join();
+    EXPECT_FALSE(t.joinable());
+
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+    EXPECT_STREQ(name, "spawned");
+    EXPECT_GE(stack_size, size_t{1} << 20);
+    EXPECT_EQ(guard_size, size_t{1} << 16);
+}
+
+TEST(thread, invalid_attributes) {
+    thread_attributes attributes;
+    attributes.name = "abcdefghijklmnop";
+    EXPECT_THROW(thread(attributes, [] {}), std::length_error);
+
+    attributes.name.clear();
+    attributes.cpus = {-1};
+    EXPECT_THROW(thread(attributes, [] {}), std::system_error);
+
+    // Not joinable
+    thread t;
+    EXPECT_THROW(t.join(), std::system_error);
+    EXPECT_THROW(t.detach(), std::system_error);
+}
+
+TEST(thread, set_name_and_core_target_owned_thread) {
+    char main_name[16] = {};
+    pthread_getname_np(pthread_self(), main_name, sizeof(main_name));
+
+    std::atomic<bool> renamed{false};
+    char name[16] = {};
+    cpu_set_t cpus;
+    thread t([&] {
+        renamed.wait(false);
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        sched_getaffinity(0, sizeof(cpus), &cpus);
+    });
+
+    EXPECT_TRUE(t.set_name("renamed"));
+    EXPECT_TRUE(t.set_core(0));
+    renamed = true;
+    renamed.notify_one();
+    t.join();
+
+    // The spawned thread changed, this one didn't
+    EXPECT_STREQ(name, "renamed");
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+
+    char after[16] = {};
+    pthread_getname_np(pthread_self(), after, sizeof(after));
+    EXPECT_STREQ(after, main_name);
+}
+
+TEST(thread, stack_node) {
+    // Default: no binding on single-node machines
+    thread t1([] {});
+    t1.join();
+
+    thread_attributes attributes;
+    attributes.stack_node = 0;
+    thread t2(attributes, [] {});
+    t2.join();
+
+    // Bound unless the kernel has no NUMA support
+    EXPECT_TRUE(t2.stack_node() == 0 || t2.stack_node() == -1);
+}
+
+TEST(thread, detach) {
+    std::atomic<bool> ran{false};
+    thread t([&ran] {
+        ran = true;
+        ran.notify_one();
+    });
+    t.detach();
+    EXPECT_FALSE(t.joinable());
+
+    ran.wait(false);
+    EXPECT_TRUE(ran);
+}
@@ -0,0 +1,177 @@
+#include "cpptools/thread_pool.hpp"
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using cpptools::thread_pool;
+using cpptools::thread_pool_options;
+
+TEST(thread_pool, constructor) {
+    thread_pool_options options;
+    options.threads = 3;
+    thread_pool pool(options);
+    EXPECT_EQ(pool.size(), 3u);
+
+    // One worker per core by default
+    thread_pool pool2;
+    EXPECT_EQ(pool2.size(),
+              std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST(thread_pool, submit) {
+    thread_pool_options options;
+    options.threads = 4;
+    thread_pool pool(options);
+
+    constexpr int num_tasks = 10000;
+    std::atomic<int> counter{0};
+    for (int i = 0; i < num_tasks; ++i) {
+        pool.submit([&] { ++counter; });
+    }
+    pool.wait();
+    EXPECT_EQ(counter, num_tasks);
+}
+
+TEST(thread_pool, submit_bulk) {
+    thread_pool_options options;
+    options.threads = 4;
+    thread_pool pool(options);
+
+    std::atomic<int> counter{0};
+    std::vector<std::function<void()>> tasks(1000, [&] { ++counter; });
+    pool.submit(tasks.begin(), tasks.end());
+    pool.wait();
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(thread_pool, submit_from_task) {
+    thread_pool_options options;
+    options.threads = 4;
+    thread_pool pool(options);
+
+    // Tasks submitted by workers go to their own deques and get stolen
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&] {
+            for (int j = 0; j < 100; ++j) {
+                pool.submit([&] { ++counter; });
+            }
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(thread_pool, destructor_runs_pending_tasks) {
+    std::atomic<int> counter{0};
+    {
+        thread_pool_options options;
+        options.threads = 2;
+        thread_pool pool(options);
+        for (int i = 0; i < 1000; ++i) {
+            pool.submit([&] { ++counter; });
+        }
+    }
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(thread_pool, parallel_for) {
+    thread_pool_options options;
+    options.threads = 4;
+    thread_pool pool(options);
+
+    constexpr size_t n = 100000;
+    std::vector<int> data(n, 0);
+    pool.parallel_for(0, n, [&](size_t i) { data[i] += static_cast<int>(i); });
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(data[i], static_cast<int>(i));
+    }
+
+    // Explicit grain, and an empty range
+    std::atomic<uint64_t> sum{0};
+    pool.parallel_for(10, 1010, [&](size_t i) { sum += i; }, 7);
+    EXPECT_EQ(sum, (10 + 1009) * 1000 / 2);
+    pool.parallel_for(5, 5, [&](size_t) { FAIL(); });
+
+    // Nested, from inside a task
+    std::atomic<int> nested{0};
+    pool.submit([&] {
+        pool.parallel_for(0, 1000, [&](size_t) { ++nested; });
+    });
+    pool.wait();
+    EXPECT_EQ(nested, 1000);
+}
+
+TEST(thread_pool, named_and_pinned_workers) {
+    thread_pool_options options;
+    options.threads = 2;
+    options.cores = {0};
+    options.name = "worker";
+    thread_pool pool(options);
+
+    // Collect the name and core of whichever worker runs each task. Wait
+    // without helping, since pool.wait() would run tasks on this thread.
+    std::mutex m;
+    std::set<std::string> names;
+    std::set<int> cores;
+    std::atomic<int> done{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&] {
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            std::scoped_lock l(m);
+            names.insert(name);
+            cores.insert(sched_getcpu());
+            ++done;
+        });
+    }
+    while (done < 100) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_FALSE(names.empty());
+    for (const std::string &name : names) {
+        EXPECT_TRUE(name == "worker-0" || name == "worker-1") << name;
+    }
+    EXPECT_EQ(cores, std::set<int>({0}));
+}
+
+TEST(thread_pool, invalid_core) {
+    // Worker 0 starts, worker 1 can't be pinned; the pool stops worker 0
+    // and throws rather than terminating
+    thread_pool_options options;
+    options.cores = {0, 1000};
+    EXPECT_THROW(thread_pool{options}, std::system_error);
+}
+
+TEST(thread_pool, park_and_wake) {
+    thread_pool_options options;
+    options.threads = 2;
+    options.spins_before_park = 1;
+    thread_pool pool(options);
+
+    // Workers park when idle and wake up for new work
+    for (int round = 0; round < 10; ++round) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        std::atomic<bool> ran{false};
+        pool.submit([&] { ran = true; });
+        while (!ran) {
+            std::this_thread::yield();
+        }
+    }
+}
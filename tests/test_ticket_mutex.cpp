@@ -0,0 +1,91 @@
+#include "cpptools/ticket_mutex.hpp"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using cpptools::ticket_mutex;
+
+TEST(ticket_mutex, constructor) { ASSERT_NO_FATAL_FAILURE(ticket_mutex{}); }
+
+TEST(ticket_mutex, try_lock) {
+    ticket_mutex m;
+
+    // Lock once - can't lock again
+    EXPECT_TRUE(m.try_lock());
+    EXPECT_FALSE(m.try_lock());
+
+    // Unlock - CAN lock again
+    m.unlock();
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(ticket_mutex, lock_unlock) {
+    ticket_mutex m;
+
+    m.lock();
+    EXPECT_FALSE(m.try_lock());
+    m.unlock();
+
+    // Works with std::scoped_lock
+    {
+        std::scoped_lock l(m);
+        EXPECT_FALSE(m.try_lock());
+    }
+    EXPECT_TRUE(m.try_lock());
+    m.unlock();
+}
+
+TEST(ticket_mutex, fifo_order) {
+    ticket_mutex m;
+    m.lock();
+
+    // Queue up threads one at a time, so that their tickets are ordered
+    constexpr int num_threads = 4;
+    std::vector<int> order;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i] {
+            std::scoped_lock l(m);
+            order.push_back(i);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // Release: threads must be served in arrival order
+    m.unlock();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    ASSERT_EQ(order.size(), num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(ticket_mutex, contended) {
+    ticket_mutex m;
+
+    constexpr int num_threads = 4;
+    constexpr int num_iters = 10000;
+    int counter{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < num_iters; ++j) {
+                std::scoped_lock l(m);
+                ++counter;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(counter, num_threads * num_iters);
+}